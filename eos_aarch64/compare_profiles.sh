@@ -0,0 +1,62 @@
+#!/bin/bash
+#
+# Builds the kernel with two make settings, by default the default and
+# perf profiles, and reports the size and BENCH deltas (second against first)
+#
+#   ./compare_profiles.sh                 # QEMU, APP=bench_kernel
+#   HAL=host APP=<app> ./compare_profiles.sh
+#
+# COMPARE names two other make settings to compare instead, e.g. the
+# interrupt controllers (see BENCH irq):
+#
+#   COMPARE="GIC=2 GIC=3" ./compare_profiles.sh
+#
+set -e
+
+HAL=${HAL:-aarch64}
+APP=${APP:-bench_kernel}
+TIMEOUT=${TIMEOUT:-120}
+COMPARE=${COMPARE:-PROFILE=default PROFILE=perf}
+
+# The setting is passed to run.sh too (GIC= picks the QEMU GIC)
+run_kernel() {
+    if [ "$HAL" = host ]; then
+        timeout "$TIMEOUT" ./eos || true
+    else
+        env "$1" timeout "$TIMEOUT" ./run.sh || true
+    fi
+}
+
+read -r A B <<< "$COMPARE"
+a=${A#*=}
+b=${B#*=}
+
+for setting in "$A" "$B"; do
+    name=${setting#*=}
+    make -s HAL="$HAL" "$setting" clean > /dev/null
+    make -s HAL="$HAL" "$setting" APP="$APP" > /dev/null
+    cp eos "eos.$name"
+    run_kernel "$setting" | tr -d '\r' | grep '^BENCH name=' > "bench.$name" || true
+done
+
+echo "== size (bytes)"
+size "eos.$a" "eos.$b"
+size "eos.$a" "eos.$b" | awk 'NR == 2 { t = $1; d = $2; b = $3 }
+    NR == 3 { printf "delta text=%+d data=%+d bss=%+d\n", $1 - t, $2 - d, $3 - b }'
+
+echo
+echo "== BENCH avg (cycles), $B against $A"
+# BENCH name=<n> param=<p> n=<samples> avg=<a> min=<m> max=<M>
+awk '
+    { split($2, n, "="); split($3, p, "="); split($5, a, "="); key = n[2] " " p[2] }
+    FNR == NR { base[key] = a[2]; order[++cnt] = key; next }
+    { perf[key] = a[2] }
+    END {
+        printf "%-16s %8s %10s %10s %8s\n", "name", "param", la, lb, "delta"
+        for (i = 1; i <= cnt; i++) {
+            k = order[i]; split(k, f, " ")
+            if (!(k in perf)) continue
+            d = base[k] ? (perf[k] - base[k]) * 100.0 / base[k] : 0
+            printf "%-16s %8s %10d %10d %+7.1f%%\n", f[1], f[2], base[k], perf[k], d
+        }
+    }' la="$a" lb="$b" "bench.$a" "bench.$b"
@@ -0,0 +1,209 @@
+/********************************************************
+ * Filename: core/blk.c
+ *
+ * Description: Asynchronous block requests
+ *     eos_blk_submit() puts a batch of requests in the device queue and
+ *     notifies the device once. The device interrupt hands each finished
+ *     request to its completion queue, where a task waits for it or
+ *     polls; the submitter never waits per sector. A semaphore counts
+ *     the free request slots of the device queue.
+ ********************************************************/
+
+#include <core/eos.h>
+
+#if EOS_CFG_BLK
+
+static eos_semaphore_t _os_blk_slots;   // free request slots in the device queue
+static int32s_t _os_blk_irq = -1;       // -1: no device
+static int64u_t _os_blk_sectors;
+
+
+/* Hands req to its completion queue */
+static void _os_blk_finish(eos_blk_request_t *req, int8u_t status)
+{
+    eos_blk_cq_t *cq = req->cq;
+
+    req->status = status;
+    if (cq) {
+        int32u_t flag = hal_disable_interrupt();
+        _os_add_node_tail(&cq->done, &req->node);
+        hal_restore_interrupt(flag);
+        eos_release_semaphore(&cq->ready);
+    }
+}
+
+
+void _os_blk_complete(void *tag, int8u_t status)
+{
+    _os_blk_finish((eos_blk_request_t *)tag, status);
+    eos_release_semaphore(&_os_blk_slots);
+}
+
+
+static void _os_blk_handler(int8s_t irqnum, void *arg)
+{
+    hal_blk_reap();
+}
+
+
+/* A request the device must not see: bad op, buffer or range */
+static int32u_t _os_blk_valid(eos_blk_request_t *req)
+{
+    if (_os_blk_irq < 0) {
+        return 0;
+    }
+    if (req->op == BLK_FLUSH) {
+        return 1;
+    }
+    if (req->op != BLK_READ && req->op != BLK_WRITE) {
+        PRINT("invalid op=%u\n", req->op);
+        return 0;
+    }
+    if (req->buf == NULL || req->count == 0 || req->count > 0xFFFFFFFFu / BLK_SECTOR_SIZE ||
+        req->sector >= _os_blk_sectors || req->count > _os_blk_sectors - req->sector) {
+        PRINT("invalid request sector=%llu count=%u buf=%p\n",
+              (unsigned long long)req->sector, req->count, req->buf);
+        return 0;
+    }
+    return 1;
+}
+
+
+void eos_blk_init_cq(eos_blk_cq_t *cq)
+{
+    cq->done = NULL;
+    eos_init_semaphore(&cq->ready, 0, FIFO);
+}
+
+
+/* Puts req in the device queue; the caller holds a slot */
+static void _os_blk_queue(eos_blk_request_t *req)
+{
+    int32u_t len = (req->op == BLK_FLUSH) ? 0 : req->count * BLK_SECTOR_SIZE;
+    int32u_t flag = hal_disable_interrupt();
+
+    req->status = BLK_PENDING;
+    req->node.pnode = req;
+    hal_blk_enqueue(req->op, req->sector, req->buf, len, req);
+    hal_restore_interrupt(flag);
+}
+
+
+_OS_HOT int32u_t eos_blk_submit(eos_blk_request_t *reqs[], int32u_t n)
+{
+    int32u_t i, queued = 0;
+
+#if EOS_CFG_ARG_CHECKS
+    if (reqs == NULL) {
+        PRINT("invalid args reqs=%p\n", (void*)reqs);
+        return 0;
+    }
+#endif
+
+    for (i = 0; i < n; i++) {
+        eos_blk_request_t *req = reqs[i];
+
+        if (!_os_blk_valid(req)) {
+            req->node.pnode = req;
+            _os_blk_finish(req, BLK_IOERR);
+            continue;
+        }
+        if (eos_acquire_semaphore(&_os_blk_slots, -1) == 0) {
+            break;      // device queue full
+        }
+        _os_blk_queue(req);
+        queued++;
+    }
+
+    /* One notification for the whole batch */
+    if (queued > 0) {
+        hal_blk_kick();
+    }
+    return i;
+}
+
+
+_OS_HOT eos_blk_request_t *eos_blk_wait(eos_blk_cq_t *cq, int32s_t timeout)
+{
+    _os_node_t *node;
+    int32u_t flag;
+
+#if EOS_CFG_ARG_CHECKS
+    if (cq == NULL) {
+        PRINT("invalid args cq=%p\n", (void*)cq);
+        return NULL;
+    }
+#endif
+
+    if (eos_acquire_semaphore(&cq->ready, timeout) == 0) {
+        return NULL;
+    }
+
+    flag = hal_disable_interrupt();
+    node = cq->done;
+    _os_remove_node(&cq->done, node);
+    hal_restore_interrupt(flag);
+
+    return (eos_blk_request_t *)node->pnode;
+}
+
+
+int8u_t eos_blk_io(int8u_t op, int64u_t sector, void *buf, int32u_t count)
+{
+    eos_blk_cq_t cq;
+    eos_blk_request_t req;
+
+    eos_blk_init_cq(&cq);
+    req.op = op;
+    req.sector = sector;
+    req.count = count;
+    req.buf = buf;
+    req.cq = &cq;
+    req.node.pnode = &req;
+
+    if (!_os_blk_valid(&req)) {
+        return BLK_IOERR;
+    }
+    eos_acquire_semaphore(&_os_blk_slots, 0);
+    _os_blk_queue(&req);
+    hal_blk_kick();
+
+    eos_blk_wait(&cq, 0);
+    return req.status;
+}
+
+
+int64u_t eos_blk_capacity(void)
+{
+    return _os_blk_sectors;
+}
+
+
+_OS_COLD void _os_init_blk()
+{
+    int32s_t irq;
+
+    PRINT("Initializing block device\n");
+
+    eos_init_semaphore(&_os_blk_slots, EOS_CFG_BLK_QUEUE_DEPTH, FIFO);
+
+    irq = hal_blk_init();
+    if (irq < 0) {
+        PRINT("no block device\n");
+        return;
+    }
+    if (irq >= IRQ_MAX) {
+        PRINT("block device irq %d has no ICB: raise EOS_CFG_IRQ_MAX\n", irq);
+        return;
+    }
+
+    _os_blk_sectors = hal_blk_capacity();
+    _os_blk_irq = irq;
+    eos_set_interrupt_handler((int8s_t)irq, _os_blk_handler, NULL);
+    hal_enable_irq_line(irq);
+
+    PRINT("block device: %llu sectors, irq %d, %u requests in flight\n",
+          (unsigned long long)_os_blk_sectors, irq, EOS_CFG_BLK_QUEUE_DEPTH);
+}
+
+#endif
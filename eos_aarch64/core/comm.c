@@ -9,6 +9,7 @@
 
 #include <core/eos.h>
 
+#if EOS_CFG_MQUEUE
 
 void eos_init_mqueue(eos_mqueue_t *mq, void *queue_start, int16u_t queue_size, int8u_t msg_size, int8u_t queue_type)
 {
@@ -26,55 +27,189 @@ void eos_init_mqueue(eos_mqueue_t *mq, void *queue_start, int16u_t queue_size, i
     mq->rear = 0;
     eos_init_semaphore(&mq->putsem, queue_size, queue_type);
     eos_init_semaphore(&mq->getsem, 0, queue_type);
+#if EOS_CFG_MQ_PRIORITY
+    mq->links = NULL;
+#endif
 
 }
 
 
-int8u_t eos_send_message(eos_mqueue_t *mq, void *message, int32s_t timeout) 
+#if EOS_CFG_MQ_PRIORITY
+#define MQ_NIL  0xFFFF      // end of a slot list
+
+void eos_init_mqueue_prio(eos_mqueue_t *mq, void *queue_start, int16u_t queue_size, int8u_t msg_size, int8u_t queue_type, int16u_t *links)
 {
-    // To be filled by students: Project 4
-    int8u_t lock_flag;
+    if (links == NULL) {
+        PRINT("links is NULL\n");
+        return;
+    }
+    eos_init_mqueue(mq, queue_start, queue_size, msg_size, queue_type);
+    if (mq == NULL || queue_start == NULL || queue_size == 0 || msg_size == 0) {
+        return;
+    }
 
-    if (!mq || !message) { /* message queue or message buffer does not exist */
-        PRINT("invalid args mq=%p msg=%p\n", (void*)mq, message);
-        return 0;
+    /* All slots free, every priority list empty */
+    for (int16u_t i = 0; i < queue_size; i++) {
+        links[i] = (int16u_t)(i + 1 < queue_size ? i + 1 : MQ_NIL);
+    }
+    mq->links = links;
+    mq->free = 0;
+    mq->ready = 0;
+    for (int8u_t p = 0; p < MQ_PRIORITIES; p++) {
+        mq->head[p] = MQ_NIL;
+        mq->tail[p] = MQ_NIL;
+    }
+}
+
+
+/*
+ * The slot lists are shared with senders in interrupt handlers, which
+ * the scheduler lock does not hold off: each list operation runs with
+ * interrupts disabled. A slot is off every list while its message is
+ * copied, and is linked for receivers only once the copy is done.
+ */
+
+/* Takes a free slot; the caller holds a put token, so one exists */
+static inline int16u_t _os_mq_alloc_slot(eos_mqueue_t *mq)
+{
+    int32u_t flag = hal_disable_interrupt();
+    int16u_t slot = mq->free;
+
+    mq->free = mq->links[slot];
+    hal_restore_interrupt(flag);
+    return slot;
+}
+
+
+/* Appends a filled slot to the list of prio */
+static inline void _os_mq_put_slot(eos_mqueue_t *mq, int16u_t slot, int8u_t prio)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    mq->links[slot] = MQ_NIL;
+    if (mq->tail[prio] == MQ_NIL) {
+        mq->head[prio] = slot;
+        mq->ready |= _os_map_table[prio];
+    } else {
+        mq->links[mq->tail[prio]] = slot;
     }
+    mq->tail[prio] = slot;
+    hal_restore_interrupt(flag);
+}
+
+
+/* Unlinks the oldest slot of the highest priority; the caller holds a
+ * get token, so a message exists */
+static inline int16u_t _os_mq_get_slot(eos_mqueue_t *mq)
+{
+    int32u_t flag = hal_disable_interrupt();
+    int8u_t prio = _os_unmap_table[mq->ready];
+    int16u_t slot = mq->head[prio];
+
+    mq->head[prio] = mq->links[slot];
+    if (mq->head[prio] == MQ_NIL) {
+        mq->tail[prio] = MQ_NIL;
+        mq->ready &= ~_os_map_table[prio];
+    }
+    hal_restore_interrupt(flag);
+    return slot;
+}
+
+
+/* Returns a slot whose message has been copied out */
+static inline void _os_mq_free_slot(eos_mqueue_t *mq, int16u_t slot)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    mq->links[slot] = mq->free;
+    mq->free = slot;
+    hal_restore_interrupt(flag);
+}
+#endif
+
+
+_OS_HOT static int8u_t _os_send_message(eos_mqueue_t *mq, void *message, int8u_t prio, int32s_t timeout)
+{
+    // To be filled by students: Project 4
+    int8u_t lock_flag;
+    int16u_t slot;
 
     /* get semaphore for writing to the message queue */
     if (eos_acquire_semaphore(&mq->putsem, timeout) == 0) {
         return 0;
     }
 
-    lock_flag = eos_lock_scheduler();
+    /* Probed from here: time blocked for a free slot belongs to other tasks */
+    PMU_BEGIN(pmu_start);
 
-    /* set pointers */
-    int8u_t *dest = (int8u_t *) mq->queue_start + mq->msg_size*mq->rear;
-    int8u_t *src = (int8u_t *) message;
+    lock_flag = eos_lock_scheduler();
 
-    /* wrap rear pointer */
-    mq->rear++;
-    if (mq->rear == mq->queue_size) {
-        mq->rear = 0;
+#if EOS_CFG_MQ_PRIORITY
+    if (mq->links) {
+        slot = _os_mq_alloc_slot(mq);
+    } else
+#endif
+    {
+#if !EOS_CFG_MQ_PRIORITY
+        (void)prio;
+#endif
+        /* wrap rear pointer */
+        slot = mq->rear;
+        mq->rear++;
+        if (mq->rear == mq->queue_size) {
+            mq->rear = 0;
+        }
     }
 
     /* copy message to the message queue */
-    for (int8u_t i = 0; i < mq->msg_size; i++) {
-        dest[i] = src[i];
+    _os_memcpy((int8u_t *)mq->queue_start + mq->msg_size * slot, message, mq->msg_size);
+
+#if EOS_CFG_MQ_PRIORITY
+    if (mq->links) {
+        _os_mq_put_slot(mq, slot, prio);
     }
+#endif
 
     eos_restore_scheduler(lock_flag);
 
     eos_release_semaphore(&mq->getsem);
 
+    PMU_END(eos_pmu_send, pmu_start);
     return mq->msg_size;
+}
+
 
+_OS_HOT int8u_t eos_send_message(eos_mqueue_t *mq, void *message, int32s_t timeout) 
+{
+    if (!mq || !message) { /* message queue or message buffer does not exist */
+        PRINT("invalid args mq=%p msg=%p\n", (void*)mq, message);
+        return 0;
+    }
+    return _os_send_message(mq, message, MQ_PRIORITIES - 1, timeout);
+}
+
+
+#if EOS_CFG_MQ_PRIORITY
+_OS_HOT int8u_t eos_send_message_prio(eos_mqueue_t *mq, void *message, int8u_t prio, int32s_t timeout)
+{
+    if (!mq || !message || prio >= MQ_PRIORITIES) {
+        PRINT("invalid args mq=%p msg=%p prio=%u\n", (void*)mq, message, (int32u_t)prio);
+        return 0;
+    }
+    if (mq->links == NULL) {
+        PRINT("queue %p has no message priorities\n", (void*)mq);
+        return 0;
+    }
+    return _os_send_message(mq, message, prio, timeout);
 }
+#endif
 
 
-int8u_t eos_receive_message(eos_mqueue_t *mq, void *message, int32s_t timeout)
+_OS_HOT int8u_t eos_receive_message(eos_mqueue_t *mq, void *message, int32s_t timeout)
 {
     // To be filled by students: Project 4
     int8u_t lock_flag;
+    int16u_t slot;
 
     if (!mq || !message) { /* message queue or output buffer does not exist */
         PRINT("invalid args mq=%p msg=%p\n", (void*)mq, message);
@@ -88,20 +223,28 @@ int8u_t eos_receive_message(eos_mqueue_t *mq, void *message, int32s_t timeout)
 
     lock_flag = eos_lock_scheduler();
 
-    /* set pointers */
-    int8u_t *src = (int8u_t *)mq->queue_start + mq->msg_size*mq->front;
-    int8u_t *dest = (int8u_t *)message;
-
-    /* wrap front pointer */
-    mq->front++;
-    if (mq->front == mq->queue_size) {
-        mq->front = 0;
+#if EOS_CFG_MQ_PRIORITY
+    if (mq->links) {
+        slot = _os_mq_get_slot(mq);
+    } else
+#endif
+    {
+        /* wrap front pointer */
+        slot = mq->front;
+        mq->front++;
+        if (mq->front == mq->queue_size) {
+            mq->front = 0;
+        }
     }
 
     /* copy message from the message queue */
-    for (int8u_t i = 0; i < mq->msg_size; i++) {
-        dest[i] = src[i];
+    _os_memcpy(message, (int8u_t *)mq->queue_start + mq->msg_size * slot, mq->msg_size);
+
+#if EOS_CFG_MQ_PRIORITY
+    if (mq->links) {
+        _os_mq_free_slot(mq, slot);
     }
+#endif
 
     eos_restore_scheduler(lock_flag);
 
@@ -109,3 +252,4 @@ int8u_t eos_receive_message(eos_mqueue_t *mq, void *message, int32s_t timeout)
 
     return mq->msg_size;
 }
+#endif
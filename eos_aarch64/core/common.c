@@ -9,21 +9,104 @@
 
 #include <core/eos.h>
 
-#define PRINT_BUFFER_SIZE 256
+#define PRINT_BUFFER_SIZE EOS_CFG_PRINT_BUFFER_SIZE
+
+/* eos_printf() streams through this chunk: lines of any length go out
+ * whole, PRINT_BUFFER_SIZE - 1 characters per _os_serial_puts() */
+typedef struct _os_serial_sink {
+    char buf[PRINT_BUFFER_SIZE];
+    size_t len;
+} _os_serial_sink_t;
+
+static void _os_serial_flush(_os_serial_sink_t *out)
+{
+    out->buf[out->len] = '\0';
+    _os_serial_puts(out->buf);
+    out->len = 0;
+}
+
+
+static void _os_serial_put(void *ctx, const char *s, size_t n)
+{
+    _os_serial_sink_t *out = (_os_serial_sink_t *)ctx;
+
+    while (n > 0) {
+        size_t room = PRINT_BUFFER_SIZE - 1 - out->len;
+        size_t k = (n < room) ? n : room;
+
+        _os_memcpy(out->buf + out->len, s, k);
+        out->len += k;
+        s += k;
+        n -= k;
+        if (out->len == PRINT_BUFFER_SIZE - 1) {
+            _os_serial_flush(out);
+        }
+    }
+}
+
 
 void eos_printf(const char *fmt, ...)
 {
     va_list args;
-    int8s_t printbuffer[PRINT_BUFFER_SIZE];
+    _os_serial_sink_t out;
 
+    out.len = 0;
     va_start(args, fmt);
-    vsprintf(printbuffer, fmt, args);
+    _os_vformat(_os_serial_put, &out, fmt, args);
     va_end(args);
 
-    _os_serial_puts(printbuffer);
+    if (out.len > 0) {
+        _os_serial_flush(&out);
+    }
 }
 
-void _os_add_node_tail(_os_node_t **head, _os_node_t *new_node) 
+
+/* Bounded output of eos_vsnprintf(): keeps room for the terminating NUL */
+typedef struct _os_buffer_sink {
+    char *buf;
+    size_t size;
+    size_t len;
+} _os_buffer_sink_t;
+
+static void _os_buffer_put(void *ctx, const char *s, size_t n)
+{
+    _os_buffer_sink_t *out = (_os_buffer_sink_t *)ctx;
+
+    if (out->len + 1 >= out->size) {
+        return;     // full (or size 0): the rest is truncated
+    }
+    if (n > out->size - 1 - out->len) {
+        n = out->size - 1 - out->len;
+    }
+    _os_memcpy(out->buf + out->len, s, n);
+    out->len += n;
+}
+
+
+int32s_t eos_vsnprintf(char *buf, size_t size, const char *fmt, va_list args)
+{
+    _os_buffer_sink_t out = { buf, size, 0 };
+    int32s_t count = _os_vformat(_os_buffer_put, &out, fmt, args);
+
+    if (size > 0) {
+        buf[out.len] = '\0';
+    }
+    return count;
+}
+
+
+int32s_t eos_snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list args;
+    int32s_t count;
+
+    va_start(args, fmt);
+    count = eos_vsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return count;
+}
+
+_OS_HOT void _os_add_node_tail(_os_node_t **head, _os_node_t *new_node) 
 {
     if (*head) {
         new_node->prev = (*head)->prev;
@@ -38,8 +121,15 @@ void _os_add_node_tail(_os_node_t **head, _os_node_t *new_node)
 }
 
 
+_OS_HOT void _os_add_node_head(_os_node_t **head, _os_node_t *new_node)
+{
+    _os_add_node_tail(head, new_node);
+    (*head) = new_node;
+}
+
+
 /* Ascending order */
-void _os_add_node_ordered(_os_node_t **head, _os_node_t *new_node)
+_OS_HOT void _os_add_node_ordered(_os_node_t **head, _os_node_t *new_node)
 {
     _os_node_t *node;
  
@@ -66,7 +156,7 @@ void _os_add_node_ordered(_os_node_t **head, _os_node_t *new_node)
 }
 
 
-int32u_t _os_remove_node(_os_node_t **head, _os_node_t *node)
+_OS_HOT int32u_t _os_remove_node(_os_node_t **head, _os_node_t *node)
 {
     // If the node doesn't exist in the list
     if (node->next == NULL || node->prev == NULL)
@@ -99,11 +189,12 @@ int32u_t _os_remove_node(_os_node_t **head, _os_node_t *node)
 #define SPECIAL	32		/* 0x */
 #define LARGE	64		/* use 'ABCDEF' instead of 'abcdef' */
 
-#define do_div(n,base) ({ \
-int __res; \
-__res = ((unsigned long) n) % (unsigned) base; \
-n = ((unsigned long) n) / (unsigned) base; \
-__res; })
+/* Conversion qualifiers: size of the integer argument */
+#define QUAL_INT	0
+#define QUAL_CHAR	1		/* hh */
+#define QUAL_SHORT	2		/* h */
+#define QUAL_LONG	3		/* l, z, t */
+#define QUAL_LLONG	4		/* ll, L, j */
 
 
 /**
@@ -133,107 +224,175 @@ static int skip_atoi(const char **s)
 }
 
 
-static char * number(char * str, long num, int base, int size, int precision, int type)
+/* Formatter state: everything goes to the sink, count is what C's
+ * printf family returns */
+typedef struct _os_format_out {
+    _os_print_sink_t sink;
+    void *ctx;
+    int32s_t count;
+} _os_format_out_t;
+
+static void out_put(_os_format_out_t *out, const char *s, size_t n)
+{
+    if (n > 0) {
+        out->sink(out->ctx, s, n);
+        out->count += (int32s_t)n;
+    }
+}
+
+
+/* Padding in pieces of up to 16 characters */
+static void out_fill(_os_format_out_t *out, char c, int32s_t n)
+{
+    static const char spaces[16] = "                ";
+    static const char zeros[16] = "0000000000000000";
+    const char *fill = (c == '0') ? zeros : spaces;
+
+    while (n > 0) {
+        int32s_t k = (n > 16) ? 16 : n;
+        out_put(out, fill, k);
+        n -= k;
+    }
+}
+
+
+static const char digit_pairs[201] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829"
+    "30313233343536373839" "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879" "80818283848586878889"
+    "90919293949596979899";
+
+/*
+ * Writes the digits of num backwards, ending just before end, and returns
+ * the first one. Base 10 takes two digits per step and divides by 100
+ * with a multiply-high (no divide instruction, even at -Os); bases 8 and
+ * 16 are shifts.
+ */
+static char *utoa_rev(char *end, int64u_t num, int32s_t base, int32s_t large)
+{
+    const char *digits = large ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *p = end;
+
+    if (base == 10) {
+        while (num >= 100) {
+            /* num / 100 = ((num >> 2) * ceil(2^68 / 100)) >> 66 */
+            int64u_t q = (int64u_t)(((unsigned __int128)(num >> 2) * 0x28F5C28F5C28F5C3ull) >> 66);
+            int32u_t r = (int32u_t)(num - q * 100);
+
+            p -= 2;
+            p[0] = digit_pairs[2 * r];
+            p[1] = digit_pairs[2 * r + 1];
+            num = q;
+        }
+        if (num >= 10) {
+            p -= 2;
+            p[0] = digit_pairs[2 * num];
+            p[1] = digit_pairs[2 * num + 1];
+        } else {
+            *--p = (char)('0' + num);
+        }
+    } else {
+        int32u_t shift = (base == 16) ? 4 : 3;
+
+        do {
+            *--p = digits[num & (base - 1)];
+            num >>= shift;
+        } while (num != 0);
+    }
+
+    return p;
+}
+
+
+/* One integer conversion; num is the magnitude, negative carries the sign */
+static void number(_os_format_out_t *out, int64u_t num, int32s_t negative,
+                   int32s_t base, int32s_t size, int32s_t precision, int32s_t type)
 {
-    char c, sign,tmp[66];
-    const char *digits = "0123456789abcdefghijklmnopqrstuvwxyz";
-    int i;
+    char tmp[24];       /* 22 octal digits of a 64-bit number */
+    char prefix[3];
+    int32s_t prefix_len = 0;
+    char *digits;
+    int32s_t len, zeros;
 
-    if (type & LARGE)
-        digits = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
     if (type & LEFT)
         type &= ~ZEROPAD;
-    if (base < 2 || base > 36)
-        return 0;
 
-    c = (type & ZEROPAD) ? '0' : ' ';
-    sign = 0;
     if (type & SIGN) {
-        if (num < 0) {
-            sign = '-';
-            num = -num;
-            size--;
+        if (negative) {
+            prefix[prefix_len++] = '-';
         } else if (type & PLUS) {
-            sign = '+';
-            size--;
+            prefix[prefix_len++] = '+';
         } else if (type & SPACE) {
-            sign = ' ';
-            size--;
+            prefix[prefix_len++] = ' ';
         }
     }
 
-    if (type & SPECIAL) {
+    if ((type & SPECIAL) && num != 0) {
         if (base == 16) {
-            size -= 2;
-	} else if (base == 8) {
-            size--;
+            prefix[prefix_len++] = '0';
+            prefix[prefix_len++] = (type & LARGE) ? 'X' : 'x';
+        } else if (base == 8) {
+            prefix[prefix_len++] = '0';
         }
     }
 
-    i = 0;
-    if (num == 0) {
-        tmp[i++]='0';
-    } else {
-        while (num != 0)
-            tmp[i++] = digits[do_div(num,base)];
-    }
-
-    if (i > precision)
-        precision = i;
-
-    size -= precision;
-    if (!(type&(ZEROPAD+LEFT)))
-        while(size-->0)
-            *str++ = ' ';
+    digits = utoa_rev(tmp + sizeof(tmp), num, base, type & LARGE);
+    len = (int32s_t)(tmp + sizeof(tmp) - digits);
 
-    if (sign)
-        *str++ = sign;
+    zeros = (precision > len) ? precision - len : 0;
+    size -= prefix_len + zeros + len;
 
-    if (type & SPECIAL) {
-        if (base==8) {
-            *str++ = '0';
-	} else if (base==16) {
-            *str++ = '0';
-            *str++ = digits[33];
-        }
-    }
-
-    if (!(type & LEFT)) {
-        while (size-- > 0)
-            *str++ = c;
+    if (type & ZEROPAD) {
+        if (size > 0)
+            zeros += size;
+        size = 0;
     }
 
-    while (i < precision--)
-        *str++ = '0';
-    while (i-- > 0)
-        *str++ = tmp[i];
-    while (size-- > 0)
-        *str++ = ' ';
-
-    return str;
+    if (!(type & LEFT))
+        out_fill(out, ' ', size);
+    out_put(out, prefix, prefix_len);
+    out_fill(out, '0', zeros);
+    out_put(out, digits, len);
+    if (type & LEFT)
+        out_fill(out, ' ', size);
 }
 
 
-int vsprintf(char *buf, const char *fmt, va_list args)
+/*
+ * Formats fmt into the sink, a piece at a time: literal text runs, padding
+ * and digit strings each go out in one call, with no intermediate buffer.
+ * Understands the C conversions c s p n % d i u o x X with the flags
+ * - + space # 0, width and precision (also '*'), and the size qualifiers
+ * hh h l ll L z t j.
+ * Returns the number of characters produced.
+ */
+int32s_t _os_vformat(_os_print_sink_t sink, void *ctx, const char *fmt, va_list args)
 {
-    int len;
-    unsigned long num;
-    int i, base;
-    char * str;
+    _os_format_out_t out = { sink, ctx, 0 };
+    va_list ap;
+    int64u_t num;
+    int32s_t negative;
+    int32s_t len, base;
     const char *s;
+    char c;
 
-    int flags;		/* flags to number() */
+    int32s_t flags;		/* flags to number() */
 
-    int field_width;	/* width of output field */
-    int precision;		/* min. # of digits for integers; max
+    int32s_t field_width;	/* width of output field */
+    int32s_t precision;		/* min. # of digits for integers; max
 				   number of chars for from string */
-    int qualifier;		/* 'h', 'l', or 'L' for integer fields */
+    int32s_t qualifier;		/* QUAL_* size of integer fields */
 
-    for (str = buf ; *fmt ; ++fmt) {
-        if (*fmt != '%') {
-            *str++ = *fmt;
-        continue;
-        }
+    va_copy(ap, args);
+
+    while (*fmt) {
+        /* Literal text up to the next conversion */
+        s = fmt;
+        while (*fmt && *fmt != '%')
+            ++fmt;
+        out_put(&out, s, fmt - s);
+        if (!*fmt)
+            break;
 
         /* Process flags */
         flags = 0;
@@ -254,7 +413,7 @@ int vsprintf(char *buf, const char *fmt, va_list args)
         } else if (*fmt == '*') {
             ++fmt;
             /* It's the next argument */
-            field_width = va_arg(args, int);
+            field_width = va_arg(ap, int);
             if (field_width < 0) {
                 field_width = -field_width;
                 flags |= LEFT;
@@ -270,17 +429,39 @@ int vsprintf(char *buf, const char *fmt, va_list args)
             } else if (*fmt == '*') {
                 ++fmt;
                 /* It's the next argument */
-                precision = va_arg(args, int);
+                precision = va_arg(ap, int);
             }
             if (precision < 0)
-            precision = 0;
-         }
+                precision = 0;
+        }
 
         /* Get the conversion qualifier */
-        qualifier = -1;
-        if (*fmt == 'h' || *fmt == 'l' || *fmt == 'L') {
-            qualifier = *fmt;
-            ++fmt;
+        qualifier = QUAL_INT;
+        switch (*fmt) {
+            case 'h':
+                qualifier = QUAL_SHORT;
+                if (*++fmt == 'h') {
+                    qualifier = QUAL_CHAR;
+                    ++fmt;
+                }
+                break;
+            case 'l':
+                qualifier = QUAL_LONG;
+                if (*++fmt == 'l') {
+                    qualifier = QUAL_LLONG;
+                    ++fmt;
+                }
+                break;
+            case 'z':
+            case 't':
+                qualifier = QUAL_LONG;      // size_t, ptrdiff_t
+                ++fmt;
+                break;
+            case 'L':
+            case 'j':
+                qualifier = QUAL_LLONG;
+                ++fmt;
+                break;
         }
 
         /* Default base */
@@ -288,62 +469,57 @@ int vsprintf(char *buf, const char *fmt, va_list args)
 
         switch (*fmt) {
             case 'c':
-                if (!(flags & LEFT)) {
-                    while (--field_width > 0)
-                        *str++ = ' ';
-                }
-
-                *str++ = (unsigned char) va_arg(args, int);
-                while (--field_width > 0)
-                    *str++ = ' ';
-
+                c = (char) va_arg(ap, int);
+                if (!(flags & LEFT))
+                    out_fill(&out, ' ', field_width - 1);
+                out_put(&out, &c, 1);
+                if (flags & LEFT)
+                    out_fill(&out, ' ', field_width - 1);
+                ++fmt;
                 continue;
 
             case 's':
-                s = va_arg(args, char *);
+                s = va_arg(ap, char *);
                 if (!s)
                     s = "<NULL>";
 
-                len = strnlen(s, precision);
-
-                if (!(flags & LEFT)) {
-                    while (len < field_width--)
-                        *str++ = ' ';
-                }
-
-                for (i = 0; i < len; ++i)
-                    *str++ = *s++;
-
-                while (len < field_width--)
-                    *str++ = ' ';
+                len = (int32s_t)strnlen(s, (size_t)precision);
 
+                if (!(flags & LEFT))
+                    out_fill(&out, ' ', field_width - len);
+                out_put(&out, s, len);
+                if (flags & LEFT)
+                    out_fill(&out, ' ', field_width - len);
+                ++fmt;
                 continue;
 
             case 'p':
                 if (field_width == -1) {
-				field_width = 2*sizeof(void *);
-				flags |= ZEROPAD;
+                    field_width = 2*sizeof(void *);
+                    flags |= ZEROPAD;
                 }
-
-                str = number(str,
-				(unsigned long) va_arg(args, void *), 16,
-				field_width, precision, flags);
-
+                number(&out, (int64u_t)(size_t) va_arg(ap, void *), 0, 16,
+                       field_width, precision, flags);
+                ++fmt;
                 continue;
 
             case 'n':
-                if (qualifier == 'l') {
-                    long * ip = va_arg(args, long *);
-                    *ip = (str - buf);
+                if (qualifier == QUAL_LLONG) {
+                    long long *ip = va_arg(ap, long long *);
+                    *ip = out.count;
+                } else if (qualifier == QUAL_LONG) {
+                    long *ip = va_arg(ap, long *);
+                    *ip = out.count;
                 } else {
-                    int * ip = va_arg(args, int *);
-                    *ip = (str - buf);
+                    int *ip = va_arg(ap, int *);
+                    *ip = out.count;
                 }
-
+                ++fmt;
                 continue;
 
             case '%':
-                *str++ = '%';
+                out_put(&out, "%", 1);
+                ++fmt;
                 continue;
 
             /* Integer number formats - set up the flags and "break" */
@@ -353,6 +529,7 @@ int vsprintf(char *buf, const char *fmt, va_list args)
 
             case 'X':
                 flags |= LARGE;
+                /* fall through */
             case 'x':
                 base = 16;
                 break;
@@ -360,36 +537,54 @@ int vsprintf(char *buf, const char *fmt, va_list args)
             case 'd':
             case 'i':
                 flags |= SIGN;
+                /* fall through */
             case 'u':
                 break;
 
             default:
-                *str++ = '%';
+                out_put(&out, "%", 1);
                 if (*fmt) {
-                    *str++ = *fmt;
-		} else {
-                    --fmt;
+                    out_put(&out, fmt, 1);
+                    ++fmt;
                 }
-
                 continue;
         } /* switch */
+        ++fmt;
+
+        negative = 0;
+        if (flags & SIGN) {
+            long long v;
+
+            if (qualifier == QUAL_LLONG)
+                v = va_arg(ap, long long);
+            else if (qualifier == QUAL_LONG)
+                v = va_arg(ap, long);
+            else if (qualifier == QUAL_SHORT)
+                v = (short) va_arg(ap, int);
+            else if (qualifier == QUAL_CHAR)
+                v = (signed char) va_arg(ap, int);
+            else
+                v = va_arg(ap, int);
+
+            negative = (v < 0);
+            num = negative ? -(int64u_t)v : (int64u_t)v;
+        } else {
+            if (qualifier == QUAL_LLONG)
+                num = va_arg(ap, unsigned long long);
+            else if (qualifier == QUAL_LONG)
+                num = va_arg(ap, unsigned long);
+            else if (qualifier == QUAL_SHORT)
+                num = (unsigned short) va_arg(ap, int);
+            else if (qualifier == QUAL_CHAR)
+                num = (unsigned char) va_arg(ap, int);
+            else
+                num = va_arg(ap, unsigned int);
+        }
 
-        if (qualifier == 'l') {
-            num = va_arg(args, unsigned long);
-	} else if (qualifier == 'h') {
-            num = (unsigned short) va_arg(args, int);
-            if (flags & SIGN)
-                num = (short) num;
-        } else if (flags & SIGN) {
-            num = va_arg(args, int);
-	} else {
-            num = va_arg(args, unsigned int);
-	}
-
-        str = number(str, num, base, field_width, precision, flags);
-    } /* for */
+        number(&out, num, negative, base, field_width, precision, flags);
+    } /* while */
 
-    *str = '\0';
+    va_end(ap);
 
-    return str-buf;
+    return out.count;
 }
@@ -0,0 +1,334 @@
+/********************************************************
+ * Filename: core/console.c
+ *
+ * Description: Kernel statistics console on the serial port
+ *     A low-priority task reads command lines with eos_uart_read() and
+ *     prints tasks, registered semaphores and queues, per-IRQ counts
+ *     and the alarm queue. State is copied in small snapshots, each
+ *     under a short interrupt-off section, and printed afterwards.
+ ********************************************************/
+
+#include <core/eos.h>
+
+#if EOS_CFG_CONSOLE
+
+#define CONSOLE_LINE_SIZE   64
+#define CONSOLE_MAX_TASKS   32
+#define CONSOLE_MAX_ALARMS  16
+
+#define OBJ_SEMAPHORE   1
+#define OBJ_MQUEUE      2
+
+typedef struct _os_console_object {
+    int8u_t type;
+    void *obj;
+    const char *name;
+} _os_console_object_t;
+
+static _os_console_object_t _os_console_objects[EOS_CFG_CONSOLE_OBJECTS];
+static int32u_t _os_console_object_count;
+
+/* Snapshots live here rather than on the console stack */
+static eos_task_stats_t _os_console_tasks[CONSOLE_MAX_TASKS];
+static eos_alarm_t _os_console_alarms[CONSOLE_MAX_ALARMS];
+
+
+static int32u_t _os_console_add(int8u_t type, void *obj, const char *name)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    for (int32u_t i = 0; i < _os_console_object_count; i++) {
+        if (_os_console_objects[i].obj == obj) {
+            _os_console_objects[i].name = name;     // re-registration renames
+            hal_restore_interrupt(flag);
+            return 0;
+        }
+    }
+    if (_os_console_object_count == EOS_CFG_CONSOLE_OBJECTS) {
+        hal_restore_interrupt(flag);
+        PRINT("console object table full (%u)\n", EOS_CFG_CONSOLE_OBJECTS);
+        return (int32u_t)-1;
+    }
+    _os_console_objects[_os_console_object_count].type = type;
+    _os_console_objects[_os_console_object_count].obj = obj;
+    _os_console_objects[_os_console_object_count].name = name;
+    _os_console_object_count++;
+    hal_restore_interrupt(flag);
+
+    return 0;
+}
+
+
+int32u_t eos_console_add_semaphore(eos_semaphore_t *sem, const char *name)
+{
+    if (sem == NULL || name == NULL) {
+        PRINT("invalid args sem=%p name=%p\n", (void*)sem, (void*)name);
+        return (int32u_t)-1;
+    }
+    return _os_console_add(OBJ_SEMAPHORE, sem, name);
+}
+
+
+#if EOS_CFG_MQUEUE
+int32u_t eos_console_add_mqueue(eos_mqueue_t *mq, const char *name)
+{
+    if (mq == NULL || name == NULL) {
+        PRINT("invalid args mq=%p name=%p\n", (void*)mq, (void*)name);
+        return (int32u_t)-1;
+    }
+    return _os_console_add(OBJ_MQUEUE, mq, name);
+}
+#endif
+
+
+static int32u_t _os_cycles_to_ms(int64u_t cycles)
+{
+    int64u_t freq = read_cntfrq_el0();
+
+    return freq ? (int32u_t)(cycles * 1000 / freq) : 0;
+}
+
+
+static void _os_console_tasks_cmd(void)
+{
+    static const char *state_names[] = { "?", "READY", "RUN", "WAIT", "SUSP" };
+    int32u_t n = eos_get_task_stats(_os_console_tasks, CONSOLE_MAX_TASKS);
+
+    eos_printf("%-18s %3s %6s %-5s %11s %9s %9s %8s\n",
+               "task", "pri", "period", "state", "stack", "run_ms", "irq_ms", "switches");
+    for (int32u_t i = 0; i < n; i++) {
+        eos_task_stats_t *st = &_os_console_tasks[i];
+        const char *state = (st->status <= SUSPENDED) ? state_names[st->status] : "?";
+
+        eos_printf("%-18p %3u %6u %-5s %5zu/%-5zu %9u %9u %8u\n",
+                   (void*)st->task, st->priority, st->period, state,
+                   eos_get_stack_usage(st->task), st->stack_size,
+                   _os_cycles_to_ms(st->run_cycles), _os_cycles_to_ms(st->irq_cycles),
+                   st->voluntary_switches + st->involuntary_switches);
+    }
+    eos_printf("load %u.%u%%\n", eos_get_system_load() / 10, eos_get_system_load() % 10);
+}
+
+
+static void _os_console_sync_cmd(void)
+{
+    eos_printf("%-16s %-4s %6s %7s\n", "name", "type", "count", "waiters");
+
+    for (int32u_t i = 0; i < _os_console_object_count; i++) {
+        _os_console_object_t *o = &_os_console_objects[i];
+        int32u_t flag;
+
+        if (o->type == OBJ_SEMAPHORE) {
+            eos_semaphore_t *sem = (eos_semaphore_t *)o->obj;
+
+            flag = hal_disable_interrupt();
+            int32s_t count = sem->count;
+            int32u_t waiters = _os_wait_queue_length(&sem->wait_queue);
+            hal_restore_interrupt(flag);
+
+            eos_printf("%-16s %-4s %6d %7u\n", o->name, "sem", count > 0 ? count : 0, waiters);
+        }
+#if EOS_CFG_MQUEUE
+        else if (o->type == OBJ_MQUEUE) {
+            eos_mqueue_t *mq = (eos_mqueue_t *)o->obj;
+
+            flag = hal_disable_interrupt();
+            int32s_t queued = mq->getsem.count;
+            int32u_t receivers = _os_wait_queue_length(&mq->getsem.wait_queue);
+            int32u_t senders = _os_wait_queue_length(&mq->putsem.wait_queue);
+            hal_restore_interrupt(flag);
+
+            eos_printf("%-16s %-4s %3d/%-2u %3u+%-3u (send+recv)\n", o->name, "mq",
+                       queued > 0 ? queued : 0, (int32u_t)mq->queue_size, senders, receivers);
+        }
+#endif
+    }
+}
+
+
+static void _os_console_irq_cmd(void)
+{
+    eos_printf("%4s %10s %-18s\n", "irq", "count", "handler");
+    for (int8s_t irq = 0; irq < IRQ_MAX; irq++) {
+        int32u_t count = eos_get_irq_count(irq);
+        eos_interrupt_handler_t handler = eos_get_interrupt_handler(irq);
+
+        if (count > 0 || handler != NULL) {
+            eos_printf("%4d %10u %p\n", irq, count, (void*)handler);
+        }
+    }
+
+#if EOS_CFG_UART_RX
+    eos_uart_stats_t uart;
+    eos_get_uart_stats(&uart);
+    eos_printf("uart rx: %u bytes in %u irqs, overruns ring %u fifo %u, errors fe %u pe %u brk %u\n",
+               uart.rx_bytes, uart.rx_irqs, uart.ring_overruns, uart.fifo_overruns,
+               uart.framing_errors, uart.parity_errors, uart.breaks);
+#endif
+}
+
+
+static void _os_console_alarms_cmd(void)
+{
+    eos_counter_t *timer = eos_get_system_timer();
+    int32u_t now = timer->tick;
+    int32u_t n = eos_get_alarms(timer, _os_console_alarms, CONSOLE_MAX_ALARMS);
+
+    eos_printf("tick %u, %u alarm(s) shown\n", now, n);
+    eos_printf("%10s %8s %-18s %-18s\n", "timeout", "in", "handler", "arg");
+    for (int32u_t i = 0; i < n; i++) {
+        eos_alarm_t *a = &_os_console_alarms[i];
+        eos_printf("%10u %8d %p %p\n", a->timeout, (int32s_t)(a->timeout - now),
+                   (void*)a->handler, a->arg);
+    }
+}
+
+
+#if EOS_CFG_PROFILE
+/* Dumps the samples taken so far and starts a new profile at the tick rate */
+static void _os_console_profile_cmd(void)
+{
+    eos_profile_dump();
+    eos_profile_start(0);
+}
+#endif
+
+
+#if EOS_CFG_PMU
+/* Per task: totals with interrupts excluded; per kernel path: per-run averages */
+static void _os_console_pmu_cmd(void)
+{
+    int32u_t n = eos_get_task_stats(_os_console_tasks, CONSOLE_MAX_TASKS);
+
+    eos_printf("%-18s %14s %14s %12s %12s\n", "task", "cycles", "instr", "l1d_miss", "br_miss");
+    for (int32u_t i = 0; i < n; i++) {
+        int64u_t *c = _os_console_tasks[i].pmu;
+
+        eos_printf("%-18p %14llu %14llu %12llu %12llu\n", (void*)_os_console_tasks[i].task,
+                   (unsigned long long)c[PMU_CYCLES], (unsigned long long)c[PMU_INSTRUCTIONS],
+                   (unsigned long long)c[PMU_L1D_MISSES], (unsigned long long)c[PMU_BRANCH_MISSES]);
+    }
+
+    eos_printf("%-18s %10s %10s %10s %10s %10s (per run)\n",
+               "path", "runs", "cycles", "instr", "l1d_miss", "br_miss");
+    for (eos_pmu_probe_t *p = eos_pmu_get_probes(); p; p = p->next) {
+        int64u_t c[PMU_COUNTERS];
+        int32u_t flag = hal_disable_interrupt();
+        int32u_t runs = p->calls;
+
+        for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+            c[i] = runs ? p->count[i] / runs : 0;
+        }
+        hal_restore_interrupt(flag);
+
+        eos_printf("%-18s %10u %10llu %10llu %10llu %10llu\n", p->name, runs,
+                   (unsigned long long)c[PMU_CYCLES], (unsigned long long)c[PMU_INSTRUCTIONS],
+                   (unsigned long long)c[PMU_L1D_MISSES], (unsigned long long)c[PMU_BRANCH_MISSES]);
+    }
+}
+#endif
+
+
+static void _os_console_help_cmd(void)
+{
+    eos_printf("commands: tasks sync irq alarms"
+#if EOS_CFG_PROFILE
+               " profile"
+#endif
+#if EOS_CFG_PMU
+               " pmu"
+#endif
+               " help\n");
+}
+
+
+static void _os_console_execute(const char *line)
+{
+    static const struct {
+        const char *name;
+        void (*run)(void);
+    } commands[] = {
+        { "tasks", _os_console_tasks_cmd },
+        { "sync", _os_console_sync_cmd },
+        { "irq", _os_console_irq_cmd },
+        { "alarms", _os_console_alarms_cmd },
+#if EOS_CFG_PROFILE
+        { "profile", _os_console_profile_cmd },
+#endif
+#if EOS_CFG_PMU
+        { "pmu", _os_console_pmu_cmd },
+#endif
+        { "help", _os_console_help_cmd },
+    };
+
+    while (*line == ' ') {
+        line++;
+    }
+    if (*line == '\0') {
+        return;
+    }
+    for (int32u_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        const char *a = commands[i].name, *b = line;
+
+        while (*a && *a == *b) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && (*b == '\0' || *b == ' ')) {
+            commands[i].run();
+            return;
+        }
+    }
+    eos_printf("unknown command: %s\n", line);
+    _os_console_help_cmd();
+}
+
+
+/* Line editing: echo, backspace, CR or LF ends the line */
+static void _os_console_task(void *arg)
+{
+    char line[CONSOLE_LINE_SIZE];
+    char chunk[16];
+    char prev = 0;
+    int32u_t len = 0;
+
+    eos_printf("\neos> ");
+    while (1) {
+        int32u_t n = eos_uart_read(chunk, sizeof(chunk), 0);
+
+        for (int32u_t i = 0; i < n; i++) {
+            char c = chunk[i];
+
+            if (c == '\n' && prev == '\r') {
+                prev = c;
+                continue;       // CR LF is one line end
+            }
+            prev = c;
+
+            if (c == '\r' || c == '\n') {
+                eos_printf("\n");
+                line[len] = '\0';
+                _os_console_execute(line);
+                len = 0;
+                eos_printf("eos> ");
+            } else if (c == '\b' || c == 0x7F) {
+                if (len > 0) {
+                    len--;
+                    eos_printf("\b \b");
+                }
+            } else if (c >= ' ' && len < CONSOLE_LINE_SIZE - 1) {
+                line[len++] = c;
+                eos_printf("%c", c);
+            }
+        }
+    }
+}
+
+
+int32u_t eos_start_console(eos_tcb_t *task, addr_t sblock_start, size_t sblock_size, int32u_t priority)
+{
+    PRINT("console task: %p, priority: %u\n", (void*)task, priority);
+    return eos_create_task(task, sblock_start, sblock_size, _os_console_task, NULL, priority);
+}
+
+#endif
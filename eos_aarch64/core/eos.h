@@ -20,21 +20,33 @@
 
 void eos_printf(const char *fmt, ...);
 
+/* Formats into buf, writing at most size bytes including the NUL;
+ * returns the length the whole text would have had (as C99 snprintf) */
+int32s_t eos_snprintf(char *buf, size_t size, const char *fmt, ...);
+int32s_t eos_vsnprintf(char *buf, size_t size, const char *fmt, va_list args);
+
 #define PRINT(format, a...) eos_printf("[%15s:%30s] ", __FILE__, __FUNCTION__); eos_printf(format, ## a);
 
+/* Trace messages of the scheduler and timer, see EOS_CFG_TRACE */
+#if EOS_CFG_TRACE
+#define TRACE(format, a...) PRINT(format, ## a)
+#else
+#define TRACE(format, a...)
+#endif
+
 
 /********************************************************
  * Hardware abstraction module
  ********************************************************/
 
 /**
- * Returns irq number currently being serviced
- * -1 means no irq is being serviced
+ * Takes the highest priority pending irq (it becomes active)
+ * -1 means no irq is pending
  */
 int32s_t hal_get_irq(void);
 
 /**
- * Acknowledges the given irq
+ * Ends the given irq (EOI)
  */
 void hal_ack_irq(int32u_t irq);
 
@@ -59,12 +71,12 @@ void hal_restore_interrupt(int32u_t flag);
 /**
  * Enables specific irq line
  */
-void hal_enable_irq_line(int32u_t irq);
+void hal_enable_irq_line(int32s_t irq);
 
 /**
  * Disables specific irq line
  */
-void hal_disable_irq_line(int32u_t irq);
+void hal_disable_irq_line(int32s_t irq);
 
 
 /********************************************************
@@ -90,6 +102,27 @@ int8s_t eos_set_interrupt_handler(int8s_t irqnum,
 /* Returns interrupt handler installed for irqnum */
 eos_interrupt_handler_t eos_get_interrupt_handler(int8s_t irqnum);
 
+/* Returns how many times irqnum was taken since boot */
+int32u_t eos_get_irq_count(int8s_t irqnum);
+
+#if EOS_CFG_THREADED_IRQ
+struct tcb;
+
+/*
+ * Registers a split (threaded) interrupt handler
+ *     top_half: runs in interrupt context with the line already masked;
+ *              keeps only what cannot wait (may be NULL)
+ *     bottom_half: runs in the given task at the given priority, after
+ *              which the line is unmasked again
+ *     task, sblock_start, sblock_size: memory for the handler task,
+ *              allocated by the user as for eos_create_task()
+ */
+int8s_t eos_set_threaded_interrupt_handler(int8s_t irqnum,
+		eos_interrupt_handler_t top_half, eos_interrupt_handler_t bottom_half,
+		void *arg, struct tcb *task, addr_t sblock_start, size_t sblock_size,
+		int32u_t priority);
+#endif
+
 
 /********************************************************
  * Timer management module
@@ -125,6 +158,13 @@ void eos_set_alarm(eos_counter_t* counter, eos_alarm_t* alarm,
 
 eos_counter_t* eos_get_system_timer();
 
+/**
+ * Copies up to max_alarms pending alarms of counter, earliest first,
+ * into alarms (handler, arg and timeout only)
+ * Returns the number of entries filled
+ */
+int32u_t eos_get_alarms(eos_counter_t *counter, eos_alarm_t *alarms, int32u_t max_alarms);
+
 void eos_trigger_counter(eos_counter_t* counter);
 
 
@@ -146,18 +186,20 @@ void eos_trigger_counter(eos_counter_t* counter);
  */
 typedef struct eos_semaphore {
     // To be filled by students: Project 4
-    int8s_t count;
-    _os_node_t *wait_queue; // 대기 큐의 헤드 노드를 가리키는 포인터 변수
-    int8u_t queue_type; // 큐에서 테스크를 선택하는 기준을 지정
-    // 0: FIFO
-    // 1: 우선순위 기반
+    volatile int32s_t count; // > 0: available units, < 0: -(number of blocked tasks)
+    _os_wait_queue_t wait_queue; // 대기 큐 (FIFO 또는 우선순위 기반)
+#if EOS_CFG_SELECT
+    struct eos_waitset *set;    // wait set the semaphore belongs to, NULL if none
+    void *set_obj;              // what eos_select() reports: the semaphore or its message queue
+    _os_node_t set_node;        // link in the set's list of ready members
+#endif
 } eos_semaphore_t;
 
 /**
  * User must allocate memory for the semaphore structure
  * before calling this function
  */
-void eos_init_semaphore(eos_semaphore_t *sem, int8s_t initial_count, int8u_t queue_type);
+void eos_init_semaphore(eos_semaphore_t *sem, int32s_t initial_count, int8u_t queue_type);
 
 /**
  * Tries to acquire semaphore
@@ -169,12 +211,12 @@ int32u_t eos_acquire_semaphore(eos_semaphore_t *sem, int32s_t timeout);
  */
 void eos_release_semaphore(eos_semaphore_t *sem);
 
+#if EOS_CFG_CONDITION
 /**
  * Condition variable structure
  */
 typedef struct eos_condition {
-    _os_node_t *wait_queue;
-    int8u_t queue_type;
+    _os_wait_queue_t wait_queue;
 } eos_condition_t;
 
 /**
@@ -192,6 +234,83 @@ void eos_wait_condition(eos_condition_t *cond, eos_semaphore_t *mutex);
  * Moves a task from wait_queue to ready_queue to wake it up
  */
 void eos_notify_condition(eos_condition_t *cond);
+#endif
+
+#if EOS_CFG_RWLOCK
+/**
+ * Reader-writer lock structure
+ */
+typedef struct eos_rwlock {
+    volatile int32s_t state;    // > 0: number of readers holding the lock, -1: held by a writer, 0: free
+    int32u_t waiting_writers;   // Number of writers blocked in write_queue
+    _os_wait_queue_t read_queue;
+    _os_wait_queue_t write_queue;
+    int8u_t prefer_writer;      // 1: new readers block while a writer is waiting
+} eos_rwlock_t;
+
+/**
+ * User must allocate memory for the rwlock structure
+ * before calling this function
+ */
+void eos_init_rwlock(eos_rwlock_t *rw, int8u_t queue_type, int8u_t prefer_writer);
+
+/**
+ * Tries to acquire the lock for reading (shared with other readers)
+ *     timeout: < 0 does not block, 0 blocks forever, otherwise ticks to wait
+ */
+int32u_t eos_acquire_read(eos_rwlock_t *rw, int32s_t timeout);
+
+/**
+ * Releases a read hold
+ */
+void eos_release_read(eos_rwlock_t *rw);
+
+/**
+ * Tries to acquire the lock for writing (exclusive)
+ */
+int32u_t eos_acquire_write(eos_rwlock_t *rw, int32s_t timeout);
+
+/**
+ * Releases the write hold
+ */
+void eos_release_write(eos_rwlock_t *rw);
+#endif
+
+#if EOS_CFG_SELECT
+/**
+ * Wait set: lets one task block on several semaphores and message
+ * queues at once. A member that gains a unit (or a message) while no
+ * task waits on it directly is put on the ready list and wakes the task
+ * in eos_select(). An object belongs to at most one set.
+ */
+typedef struct eos_waitset {
+    _os_node_t *ready;          // members that may have a unit, in the order they got one
+    _os_wait_queue_t wait_queue;    // tasks in eos_select()
+} eos_waitset_t;
+
+void eos_init_waitset(eos_waitset_t *set);
+
+/**
+ * Adds a member; one that already has units is ready at once
+ * Returns 0, or -1 if it belongs to another set
+ */
+int32u_t eos_waitset_add_semaphore(eos_waitset_t *set, eos_semaphore_t *sem);
+
+/**
+ * Removes a member; a task blocked in eos_select() is not woken
+ */
+void eos_waitset_remove_semaphore(eos_waitset_t *set, eos_semaphore_t *sem);
+
+/**
+ * Waits until a member is ready
+ *     timeout: < 0 does not block, 0 blocks forever, otherwise ticks to wait
+ *     Returns the member (the semaphore, or the message queue added with
+ *     eos_waitset_add_mqueue()), NULL on timeout. The caller then takes
+ *     from it with timeout -1; that fails only if another task took the
+ *     unit first. Members that stay ready are reported in turn.
+ */
+void *eos_select(eos_waitset_t *set, int32s_t timeout);
+#endif
 
 extern int8u_t eos_lock_scheduler();
 extern void eos_restore_scheduler(int8u_t lock);
@@ -202,6 +321,9 @@ extern int8u_t eos_get_scheduler_lock();
  * Message queue module 
  ********************************************************/
 
+#if EOS_CFG_MQUEUE
+#define MQ_PRIORITIES   8   // message priorities, 0 being the most urgent
+
 /**
  * Message queue structure
  */
@@ -215,6 +337,15 @@ typedef struct eos_mqueue {
     int8u_t queue_type;  // 0: FIFO, 1: priority
     eos_semaphore_t putsem;
     eos_semaphore_t getsem;
+#if EOS_CFG_MQ_PRIORITY
+    /* Message priorities: slots are linked into one FIFO list per
+     * priority, found through a bitmap as in the ready queue */
+    int16u_t *links;     // NULL: plain circular queue; else next slot of each slot
+    int16u_t free;       // first free slot
+    int8u_t ready;       // bit p set: list p holds messages
+    int16u_t head[MQ_PRIORITIES];
+    int16u_t tail[MQ_PRIORITIES];
+#endif
 } eos_mqueue_t;
 
 /**
@@ -225,19 +356,229 @@ void eos_init_mqueue(eos_mqueue_t *mq, void *queue_start, int16u_t queue_size, i
 
 /**
  * Tries to send a message
+ *     On a queue with message priorities it is sent at MQ_PRIORITIES - 1
  */
 int8u_t eos_send_message(eos_mqueue_t *mq, void *message, int32s_t timeout);
 
 /**
  * Tries to recieve a message
+ *     On a queue with message priorities it is the oldest message of the
+ *     highest priority
  */
 int8u_t eos_receive_message(eos_mqueue_t *mq, void *message, int32s_t timeout);
 
+#if EOS_CFG_MQ_PRIORITY
+/**
+ * Sets up a queue whose messages carry a priority
+ *     links: queue_size entries allocated by the user, used to chain
+ *         message slots; messages are never moved once written
+ *     Sending and receiving take constant time.
+ */
+void eos_init_mqueue_prio(eos_mqueue_t *mq, void *queue_start, int16u_t queue_size,
+		int8u_t msg_size, int8u_t queue_type, int16u_t *links);
+
+/**
+ * Sends a message at the given priority, 0 being the most urgent
+ * (0 .. MQ_PRIORITIES - 1); only for queues from eos_init_mqueue_prio()
+ */
+int8u_t eos_send_message_prio(eos_mqueue_t *mq, void *message, int8u_t prio, int32s_t timeout);
+#endif
+
+#if EOS_CFG_SELECT
+/**
+ * Adds a message queue to a wait set: it is ready while it holds messages
+ */
+int32u_t eos_waitset_add_mqueue(eos_waitset_t *set, eos_mqueue_t *mq);
+
+void eos_waitset_remove_mqueue(eos_waitset_t *set, eos_mqueue_t *mq);
+#endif
+#endif
+
+
+/********************************************************
+ * Serial input module
+ ********************************************************/
+
+#if EOS_CFG_UART_RX
+/**
+ * Receive counters since boot
+ */
+typedef struct eos_uart_stats {
+    int32u_t rx_bytes;          // bytes stored in the receive ring
+    int32u_t rx_irqs;           // receive interrupts (one per burst)
+    int32u_t ring_overruns;     // bytes dropped because the ring was full
+    int32u_t fifo_overruns;     // UART FIFO overruns (bytes lost in hardware)
+    int32u_t framing_errors;
+    int32u_t parity_errors;
+    int32u_t breaks;
+} eos_uart_stats_t;
+
+/**
+ * Reads up to size bytes received on the console UART
+ * Blocks until at least one byte is available
+ * (timeout: <0 try only, 0 wait forever, >0 ticks)
+ * Returns the number of bytes read, 0 on timeout
+ */
+int32u_t eos_uart_read(void *buf, int32u_t size, int32s_t timeout);
+
+/**
+ * Copies the receive counters into stats
+ */
+void eos_get_uart_stats(eos_uart_stats_t *stats);
+#endif
+
+
+/********************************************************
+ * Block device module
+ ********************************************************/
+
+#if EOS_CFG_BLK
+#define BLK_SECTOR_SIZE     512
+
+/* Request operations (virtio-blk request types) */
+#define BLK_READ            0
+#define BLK_WRITE           1
+#define BLK_FLUSH           4   // completes once earlier writes are on the medium
+
+/* Request status */
+#define BLK_OK              0
+#define BLK_IOERR           1
+#define BLK_UNSUPP          2   // e.g. a flush the device does not offer
+#define BLK_PENDING         0xFF
+
+/**
+ * Completion queue: finished requests in completion order
+ */
+typedef struct eos_blk_cq {
+    _os_node_t *done;           // completed requests, oldest first
+    eos_semaphore_t ready;      // one unit per request in done
+} eos_blk_cq_t;
+
+/**
+ * Block request; filled by the user, owned by the kernel from
+ * eos_blk_submit() until it comes back from eos_blk_wait()
+ */
+typedef struct eos_blk_request {
+    int8u_t op;                 // BLK_READ, BLK_WRITE, BLK_FLUSH
+    volatile int8u_t status;    // BLK_PENDING while in flight
+    int64u_t sector;            // first sector
+    int32u_t count;             // number of sectors (0 for BLK_FLUSH)
+    void *buf;                  // count * BLK_SECTOR_SIZE bytes
+    eos_blk_cq_t *cq;           // where the request goes when it completes
+    void *arg;                  // for the user, not touched by the kernel
+    _os_node_t node;            // link in cq->done
+} eos_blk_request_t;
+
+/**
+ * User must allocate memory for the completion queue
+ * before calling this function
+ */
+void eos_blk_init_cq(eos_blk_cq_t *cq);
+
+/**
+ * Queues up to n requests to the device and notifies it once for all
+ * of them; never blocks
+ * Returns how many of reqs, from the first, were accepted: the rest
+ * did not fit in the device queue and can be submitted again after
+ * earlier requests completed
+ */
+int32u_t eos_blk_submit(eos_blk_request_t *reqs[], int32u_t n);
+
+/**
+ * Takes the oldest completed request off cq
+ * (timeout: <0 try only, 0 wait forever, >0 ticks)
+ * Returns NULL if none completed in time
+ */
+eos_blk_request_t *eos_blk_wait(eos_blk_cq_t *cq, int32s_t timeout);
+
+/**
+ * Synchronous read, write or flush of count sectors
+ * Waits for room in the device queue and for the completion
+ * Returns the request status
+ */
+int8u_t eos_blk_io(int8u_t op, int64u_t sector, void *buf, int32u_t count);
+
+/**
+ * Returns the capacity of the disk in sectors, 0 if there is none
+ */
+int64u_t eos_blk_capacity(void);
+#endif
+
+
+/********************************************************
+ * Performance monitor module
+ ********************************************************/
+
+#if EOS_CFG_PMU
+/* Counter slots, the same on every HAL; a slot the CPU lacks reads 0 */
+#define PMU_CYCLES          0
+#define PMU_INSTRUCTIONS    1
+#define PMU_L1D_MISSES      2   // L1 data cache refills
+#define PMU_BRANCH_MISSES   3   // mispredicted branches
+#define PMU_COUNTERS        4
+
+/* Counter deltas summed over every bracketed run of a code path */
+typedef struct eos_pmu_probe {
+    const char *name;
+    int32u_t calls;
+    int64u_t count[PMU_COUNTERS];
+    struct eos_pmu_probe *next;
+} eos_pmu_probe_t;
+
+/* Kernel paths: eos_schedule() up to the switch, eos_send_message(),
+ * and IRQ entry up to the scheduling decision */
+extern eos_pmu_probe_t eos_pmu_schedule;
+extern eos_pmu_probe_t eos_pmu_send;
+extern eos_pmu_probe_t eos_pmu_irq;
+
+/**
+ * Reads the low 32 bits of every counter; differences are taken
+ * modulo 2^32, so a bracketed run must be shorter than 2^32 cycles
+ */
+void eos_pmu_read(int32u_t counts[PMU_COUNTERS]);
+
+/**
+ * Registers probe under name, for eos_pmu_get_probes()
+ */
+void eos_pmu_init_probe(eos_pmu_probe_t *probe, const char *name);
+
+/**
+ * Ends one run of a path: adds the counts since start (eos_pmu_read() at
+ * the beginning of the path) to probe. The start is kept by the caller,
+ * so nested and preempted runs of one probe do not disturb each other,
+ * but a run that blocks or wakes a higher-priority task also counts what
+ * ran meanwhile.
+ */
+void eos_pmu_add(eos_pmu_probe_t *probe, const int32u_t start[PMU_COUNTERS]);
+
+/**
+ * Returns the first registered probe; the rest follow through next
+ */
+eos_pmu_probe_t *eos_pmu_get_probes(void);
+
+/* Brackets a path in kernel or user code; compiles away without EOS_CFG_PMU */
+#define PMU_BEGIN(start)        int32u_t start[PMU_COUNTERS]; eos_pmu_read(start)
+#define PMU_END(probe, start)   eos_pmu_add(&(probe), start)
+#else
+#define PMU_BEGIN(start)
+#define PMU_END(probe, start)
+#endif
+
 
 /********************************************************
  * Task management module
  ********************************************************/
 
+/* Per-job timing of a periodic task, in ticks */
+typedef struct eos_period_stats {
+    int32u_t jobs;              // Jobs completed (calls to eos_wait_next_period after a release)
+    int32u_t dropped_releases;  // Releases skipped because an earlier job was still running
+    int32u_t deadline_misses;   // Jobs that completed after their relative deadline
+    int32u_t max_response;      // Longest release-to-completion time
+    int32u_t min_start_delay;   // Shortest release-to-start time
+    int32u_t max_start_delay;   // Longest release-to-start time (jitter = max - min)
+} eos_period_stats_t;
+
 /* TCB (task control block) structure */
 typedef struct tcb {
     // To by filled by students: Projects 2, 3, and 4
@@ -245,11 +586,35 @@ typedef struct tcb {
     addr_t sp;                  // Project 2
     int32u_t priority;          // Project 2
     int32u_t period;            // Project 3
-    int32u_t wakeup_time;       // Project 3
+    int32u_t wakeup_time;       // Project 3, release time of the current job
+    int32u_t deadline;          // Relative deadline of each job, 0: equal to the period
+    int32u_t offset;            // Releases happen at offset + k * period (system ticks)
+    eos_period_stats_t period_stats;
     eos_alarm_t alarm;          // Project 3
     _os_node_t queue_node;      // Project 2
-    _os_node_t **wait_queue_owner; // Project 4, pointer to the wait queue that the task is currently waiting on
+    _os_wait_queue_t *wait_queue_owner; // Project 4, pointer to the wait queue that the task is currently waiting on
                                   // NULL if the task is not waiting on any queue
+    int32s_t wait_result;       // Set when leaving a wait queue: 1 if woken (or handed a resource) by another task, 0 on timeout
+#if EOS_CFG_TASK_STATS
+    int64u_t run_cycles;        // CNTPCT cycles spent running the task
+    int64u_t irq_cycles;        // CNTPCT cycles spent in interrupts taken while the task was running
+    int32u_t voluntary_switches;    // Switches away because the task blocked or slept
+    int32u_t involuntary_switches;  // Switches away because the task was preempted
+    int32u_t releases;          // Times the task was made ready after waiting
+    addr_t stack_start;         // Stack block, filled with STACK_FILL at creation
+    size_t stack_size;
+#endif
+#if EOS_CFG_PMU
+    int64u_t pmu[PMU_COUNTERS]; // PMU counts while the task ran, interrupts excluded
+#endif
+    struct tcb *next_task;      // Link in the list of all tasks
+#if EOS_CFG_NOTIFY
+    volatile int32u_t notify_value; // Notification word, see eos_notify()
+    int8u_t notify_pending;     // 1: notified since the last wait
+    _os_wait_queue_t notify_queue;  // Holds the task itself while it waits for a notification
+#endif
+    int32u_t time_slice;        // Ticks the task runs before yielding to equal-priority tasks, 0: no rotation
+    int32u_t slice_left;        // Ticks left in the current slice, 0: rotate at the next reschedule
 } eos_tcb_t;
 
 /**
@@ -284,15 +649,188 @@ int32u_t eos_get_priority(eos_tcb_t *task);
  *     task: tcb of the task
  *     period: period of the task in tick unit
  *         period being 0 means that the task is aperiodic
+ *     Releases are aligned to absolute ticks offset + k * period, so tasks
+ *     configured at different times keep their relative phase.
  */
 void eos_set_period(eos_tcb_t *task, int32u_t period);
 
 int32u_t eos_get_period(eos_tcb_t *task);
 
+/**
+ * Sets the release offset (phase) of a periodic task in ticks
+ *     A task with an offset should call eos_wait_next_period() before
+ *     its first job.
+ */
+void eos_set_release_offset(eos_tcb_t *task, int32u_t offset);
+
+/**
+ * Sets the relative deadline of each job in ticks (0: equal to the period)
+ */
+void eos_set_deadline(eos_tcb_t *task, int32u_t deadline);
+
+/**
+ * Completes the current job and sleeps until the next release
+ *     Returns the number of releases that passed while the job was still
+ *     running. Those jobs are dropped and the task resumes at once at the
+ *     most recent release, keeping its phase.
+ */
+int32u_t eos_wait_next_period();
+
+/**
+ * Copies the periodic timing statistics of the specified task
+ */
+void eos_get_period_stats(eos_tcb_t *task, eos_period_stats_t *stats);
+
+/**
+ * Sets the round-robin time slice of the specified task
+ *     ticks: ticks the task may run while other tasks of the same
+ *         priority are ready; 0 means it runs until it blocks or yields
+ */
+void eos_set_time_slice(eos_tcb_t *task, int32u_t ticks);
+
+int32u_t eos_get_time_slice(eos_tcb_t *task);
+
+/**
+ * Moves the running task behind the other ready tasks of its priority
+ */
+void eos_yield();
+
 int32u_t eos_suspend_task(eos_tcb_t *task);
 
 int32u_t eos_resume_task(eos_tcb_t *task);
 
 void eos_sleep(int32u_t tick);
 
+#if EOS_CFG_NOTIFY
+/**
+ * Direct-to-task notifications
+ *     Each task has a notification word that other tasks and ISRs update
+ *     with eos_notify(). It replaces a binary or counting semaphore whose
+ *     only waiter is that task.
+ */
+#define NOTIFY_GIVE         0   // value += 1 (counting semaphore)
+#define NOTIFY_INCREMENT    1   // value += arg
+#define NOTIFY_SET_BITS     2   // value |= arg (event flags)
+#define NOTIFY_OVERWRITE    3   // value = arg (mailbox)
+#define NOTIFY_NO_OVERWRITE 4   // value = arg unless a notification is pending
+
+/**
+ * Notifies the specified task and wakes it if it is waiting
+ *     Returns 0 only if NOTIFY_NO_OVERWRITE found a pending notification
+ */
+int32u_t eos_notify(eos_tcb_t *task, int32u_t arg, int8u_t action);
+
+/**
+ * Waits for a nonzero notification word, used with NOTIFY_GIVE
+ *     clear: 1 resets the word to 0 (binary), 0 decrements it (counting)
+ *     timeout: < 0 does not block, 0 blocks forever, otherwise ticks to wait
+ *     Returns the word before it was cleared or decremented, 0 on timeout
+ */
+int32u_t eos_take_notification(int8u_t clear, int32s_t timeout);
+
+/**
+ * Waits for a pending notification of any kind
+ *     clear_on_exit: bits cleared in the word after it is read
+ *     value: receives the word (may be NULL)
+ *     Returns 1 if notified, 0 on timeout
+ */
+int32u_t eos_wait_notification(int32u_t clear_on_exit, int32u_t *value, int32s_t timeout);
+#endif
+
+#if EOS_CFG_TASK_STATS
+/**
+ * Snapshot of a task's CPU usage
+ */
+typedef struct eos_task_stats {
+    eos_tcb_t *task;
+    int32u_t priority;
+    int32u_t period;
+    int8u_t status;
+    size_t stack_size;
+    int64u_t run_cycles;
+    int64u_t irq_cycles;
+    int32u_t voluntary_switches;
+    int32u_t involuntary_switches;
+    int32u_t releases;
+#if EOS_CFG_PMU
+    int64u_t pmu[PMU_COUNTERS];
+#endif
+} eos_task_stats_t;
+
+/**
+ * Copies the statistics of up to max_tasks tasks into stats
+ * Returns the number of entries filled
+ */
+int32u_t eos_get_task_stats(eos_task_stats_t *stats, int32u_t max_tasks);
+
+/**
+ * Returns the deepest stack use of the task so far, in bytes
+ * (untouched STACK_FILL bytes above the bottom of its stack block)
+ * Scans the stack with interrupts enabled
+ */
+size_t eos_get_stack_usage(eos_tcb_t *task);
+
+/**
+ * Returns the share of CPU time not spent in the idle task since boot,
+ * in per-mille (0..1000)
+ */
+int32u_t eos_get_system_load(void);
+#endif
+
+/**
+ * Returns the tcb of the idle task
+ */
+eos_tcb_t *eos_get_idle_task();
+
+
+/********************************************************
+ * Profiler module
+ ********************************************************/
+
+#if EOS_CFG_PROFILE
+/**
+ * Starts sampling the interrupted PC and the running task into a ring
+ * of EOS_CFG_PROFILE_SAMPLES, dropping what was sampled before
+ *     hz: 0 samples on every system tick, otherwise the HAL profiling
+ *         timer interrupts at hz (CNTV on aarch64)
+ */
+void eos_profile_start(int32u_t hz);
+
+/**
+ * Stops sampling; the ring is kept for eos_profile_dump()
+ */
+void eos_profile_stop(void);
+
+/**
+ * Prints the ring on the serial port as "PROF <pc> <task>" lines, oldest
+ * first; ./profile.sh symbolizes a log against the eos ELF
+ */
+void eos_profile_dump(void);
+#endif
+
+
+/********************************************************
+ * Console module
+ ********************************************************/
+
+#if EOS_CFG_CONSOLE
+/**
+ * Starts the statistics console: a task that reads commands from the
+ * UART (tasks, sync, irq, alarms, profile, pmu, help) and prints kernel state
+ *     task, sblock_start, sblock_size: as for eos_create_task()
+ *     priority: normally just above the idle task
+ */
+int32u_t eos_start_console(eos_tcb_t *task, addr_t sblock_start,
+		size_t sblock_size, int32u_t priority);
+
+/**
+ * Lists a semaphore or message queue under name in the "sync" command
+ * The object and the name must stay valid
+ */
+int32u_t eos_console_add_semaphore(eos_semaphore_t *sem, const char *name);
+#if EOS_CFG_MQUEUE
+int32u_t eos_console_add_mqueue(eos_mqueue_t *mq, const char *name);
+#endif
+#endif
+
 #endif /*EOS_H*/
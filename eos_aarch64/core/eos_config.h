@@ -0,0 +1,250 @@
+/********************************************************
+ * Filename: core/eos_config.h
+ *
+ * Description: Compile-time configuration of eOS
+ *     Every limit and optional module of the kernel is set here.
+ *     Each value can be overridden from the command line,
+ *     e.g. make CFLAGS+=-DEOS_CFG_MQUEUE=0
+ ********************************************************/
+
+#ifndef EOS_CONFIG_H
+#define EOS_CONFIG_H
+
+
+/********************************************************
+ * Limits
+ ********************************************************/
+
+/* Lowest task priority (0 is the highest); at most 63 with the
+ * two-level ready bitmap, smaller values shrink the ready table */
+#ifndef EOS_CFG_LOWEST_PRIORITY
+#define EOS_CFG_LOWEST_PRIORITY     63
+#endif
+
+/* Number of interrupt lines with an ICB: SGIs, PPIs and the first
+ * 64 SPIs (the QEMU virt UART is 33, virtio-mmio transports 48..79) */
+#ifndef EOS_CFG_IRQ_MAX
+#define EOS_CFG_IRQ_MAX             96
+#endif
+
+/* Interrupt controller of the aarch64 HAL: 2 (GICv2, memory-mapped CPU
+ * interface) or 3 (GICv3, system registers); make GIC=3 sets it, and
+ * run.sh must be given the same GIC= */
+#ifndef EOS_CFG_GIC_VERSION
+#define EOS_CFG_GIC_VERSION         2
+#endif
+
+/* System timer ticks per second */
+#ifndef EOS_CFG_TICK_HZ
+#define EOS_CFG_TICK_HZ             1u
+#endif
+
+/* Smallest stack block accepted by eos_create_task() */
+#ifndef EOS_CFG_MIN_STACK_SIZE
+#define EOS_CFG_MIN_STACK_SIZE      1024
+#endif
+
+/* Stack block of the idle task */
+#ifndef EOS_CFG_IDLE_STACK_SIZE
+#define EOS_CFG_IDLE_STACK_SIZE     8096
+#endif
+
+/* Chunk in which eos_printf() hands its text to the serial port */
+#ifndef EOS_CFG_PRINT_BUFFER_SIZE
+#define EOS_CFG_PRINT_BUFFER_SIZE   256
+#endif
+
+/* Bytes buffered between the UART receive interrupt and eos_uart_read(),
+ * a power of two */
+#ifndef EOS_CFG_UART_RX_SIZE
+#define EOS_CFG_UART_RX_SIZE        256
+#endif
+
+/* Requests in flight on the block device at once; the virtqueue gets
+ * three descriptors per request, a power of two */
+#ifndef EOS_CFG_BLK_QUEUE_DEPTH
+#define EOS_CFG_BLK_QUEUE_DEPTH     32
+#endif
+
+/* Samples kept by the PC sampling profiler, a power of two */
+#ifndef EOS_CFG_PROFILE_SAMPLES
+#define EOS_CFG_PROFILE_SAMPLES     1024
+#endif
+
+/* Semaphores and queues the console can list (eos_console_add_*) */
+#ifndef EOS_CFG_CONSOLE_OBJECTS
+#define EOS_CFG_CONSOLE_OBJECTS     16
+#endif
+
+/* Level blocks lent to PRIORITY wait queues that have waiters, so that
+ * they block and wake in constant time (about 530 bytes each with 64
+ * priorities); a queue finding none left keeps an ordered list */
+#ifndef EOS_CFG_WAIT_LEVEL_BLOCKS
+#define EOS_CFG_WAIT_LEVEL_BLOCKS   8
+#endif
+
+/* Spinlocks one CPU may hold or wait for at once, which sizes the
+ * per-CPU node pool of MCS locks; at least SPINLOCK_KERNEL_NESTING
+ * (eos_internal.h), more for user code that nests spinlocks */
+#ifndef EOS_CFG_SPINLOCK_NESTING
+#define EOS_CFG_SPINLOCK_NESTING    4
+#endif
+
+/* Round-robin time slice given to new tasks, in ticks (0: no rotation) */
+#ifndef EOS_CFG_DEFAULT_TIME_SLICE
+#define EOS_CFG_DEFAULT_TIME_SLICE  1
+#endif
+
+
+/********************************************************
+ * Optional modules (1: built in, 0: left out)
+ ********************************************************/
+
+/* Message queues (core/comm.c) */
+#ifndef EOS_CFG_MQUEUE
+#define EOS_CFG_MQUEUE              1
+#endif
+
+/* Message priorities in queues set up with eos_init_mqueue_prio() */
+#ifndef EOS_CFG_MQ_PRIORITY
+#define EOS_CFG_MQ_PRIORITY         EOS_CFG_MQUEUE
+#endif
+
+/* Condition variables */
+#ifndef EOS_CFG_CONDITION
+#define EOS_CFG_CONDITION           1
+#endif
+
+/* Reader-writer locks */
+#ifndef EOS_CFG_RWLOCK
+#define EOS_CFG_RWLOCK              1
+#endif
+
+/* Waiting on several semaphores and message queues at once (eos_select) */
+#ifndef EOS_CFG_SELECT
+#define EOS_CFG_SELECT              1
+#endif
+
+/* Direct-to-task notifications */
+#ifndef EOS_CFG_NOTIFY
+#define EOS_CFG_NOTIFY              1
+#endif
+
+/* Threaded interrupt handlers (need notifications) */
+#ifndef EOS_CFG_THREADED_IRQ
+#define EOS_CFG_THREADED_IRQ        EOS_CFG_NOTIFY
+#endif
+
+/* Interrupt-driven UART receive (eos_uart_read) */
+#ifndef EOS_CFG_UART_RX
+#define EOS_CFG_UART_RX             1
+#endif
+
+/* Block device with asynchronous requests (eos_blk_submit) */
+#ifndef EOS_CFG_BLK
+#define EOS_CFG_BLK                 1
+#endif
+
+/* Per-task CPU time and switch statistics, stack use */
+#ifndef EOS_CFG_TASK_STATS
+#define EOS_CFG_TASK_STATS          1
+#endif
+
+/* PC sampling profiler (eos_profile_start) */
+#ifndef EOS_CFG_PROFILE
+#define EOS_CFG_PROFILE             1
+#endif
+
+/* PMU event counters per task and on kernel paths (eos_pmu_read) */
+#ifndef EOS_CFG_PMU
+#define EOS_CFG_PMU                 EOS_CFG_TASK_STATS
+#endif
+
+/* Statistics console on the UART, see eos_start_console() */
+#ifndef EOS_CFG_CONSOLE
+#define EOS_CFG_CONSOLE             (EOS_CFG_UART_RX && EOS_CFG_TASK_STATS)
+#endif
+
+/* NULL and range checks on the arguments of kernel calls */
+#ifndef EOS_CFG_ARG_CHECKS
+#define EOS_CFG_ARG_CHECKS          1
+#endif
+
+/* Scheduler and timer trace messages */
+#ifndef EOS_CFG_TRACE
+#define EOS_CFG_TRACE               1
+#endif
+
+
+/********************************************************
+ * Code placement
+ ********************************************************/
+
+/* Marks scheduler, IRQ and IPC hot paths for .text.hot and init code
+ * for .text.unlikely; linker.ld keeps the hot paths contiguous */
+#ifndef EOS_CFG_HOT_COLD
+#define EOS_CFG_HOT_COLD            1
+#endif
+
+#if EOS_CFG_HOT_COLD
+#define _OS_HOT     __attribute__((hot))
+#define _OS_COLD    __attribute__((cold))
+#else
+#define _OS_HOT
+#define _OS_COLD
+#endif
+
+
+/********************************************************
+ * Consistency checks
+ ********************************************************/
+
+#if EOS_CFG_LOWEST_PRIORITY < 1 || EOS_CFG_LOWEST_PRIORITY > 63
+#error "EOS_CFG_LOWEST_PRIORITY must be within 1..63"
+#endif
+
+#if EOS_CFG_SPINLOCK_NESTING < 1
+#error "EOS_CFG_SPINLOCK_NESTING must be at least 1"
+#endif
+
+#if EOS_CFG_IRQ_MAX < 1 || EOS_CFG_IRQ_MAX > 127
+#error "EOS_CFG_IRQ_MAX must be within 1..127 (irq numbers are int8s_t)"
+#endif
+
+#if EOS_CFG_GIC_VERSION != 2 && EOS_CFG_GIC_VERSION != 3
+#error "EOS_CFG_GIC_VERSION must be 2 or 3"
+#endif
+
+#if EOS_CFG_UART_RX_SIZE & (EOS_CFG_UART_RX_SIZE - 1)
+#error "EOS_CFG_UART_RX_SIZE must be a power of two"
+#endif
+
+#if EOS_CFG_BLK_QUEUE_DEPTH < 1 || (EOS_CFG_BLK_QUEUE_DEPTH & (EOS_CFG_BLK_QUEUE_DEPTH - 1))
+#error "EOS_CFG_BLK_QUEUE_DEPTH must be a power of two"
+#endif
+
+#if EOS_CFG_PROFILE_SAMPLES < 1 || (EOS_CFG_PROFILE_SAMPLES & (EOS_CFG_PROFILE_SAMPLES - 1))
+#error "EOS_CFG_PROFILE_SAMPLES must be a power of two"
+#endif
+
+#if EOS_CFG_PRINT_BUFFER_SIZE < 2
+#error "EOS_CFG_PRINT_BUFFER_SIZE must be at least 2"
+#endif
+
+#if EOS_CFG_THREADED_IRQ && !EOS_CFG_NOTIFY
+#error "EOS_CFG_THREADED_IRQ requires EOS_CFG_NOTIFY"
+#endif
+
+#if EOS_CFG_MQ_PRIORITY && !EOS_CFG_MQUEUE
+#error "EOS_CFG_MQ_PRIORITY requires EOS_CFG_MQUEUE"
+#endif
+
+#if EOS_CFG_PMU && !EOS_CFG_TASK_STATS
+#error "EOS_CFG_PMU requires EOS_CFG_TASK_STATS"
+#endif
+
+#if EOS_CFG_CONSOLE && !(EOS_CFG_UART_RX && EOS_CFG_TASK_STATS)
+#error "EOS_CFG_CONSOLE requires EOS_CFG_UART_RX and EOS_CFG_TASK_STATS"
+#endif
+
+#endif // EOS_CONFIG_H
@@ -12,9 +12,15 @@
 
 #include <stdio.h>
 #include <stdarg.h>
-#include <hal/aarch64/type.h>
-#include <hal/aarch64/context.h>
-#include <hal/aarch64/timer.h>
+#include <core/eos_config.h>
+/* hal/current links to the HAL selected with HAL=<name> (see Makefile) */
+#include <hal/current/type.h>
+#include <hal/current/context.h>
+#include <hal/current/timer.h>
+#include <hal/current/smp.h>
+#include <hal/current/uart.h>
+#include <hal/current/blk.h>
+#include <hal/current/pmu.h>
 
 
 /********************************************************
@@ -26,18 +32,96 @@ void _os_init_hal();		// Initialize HAL
 void _os_init_icb_table();	// Initialize ICB table structure
 void _os_init_scheduler();	// Initialize bitmap scheduler module
 void _os_init_task();		// Initialize task management module
-// void _os_init_timer();		// Initialize timer management module
+// void _os_init_timer();
+
+/* Takes a profiler sample if it runs on the system tick */
+void _os_profile_tick(void);
+
+void _os_init_pmu();
+
+/* Charges the PMU counts since the last call to task (NULL: to nobody) */
+struct tcb;
+void _os_pmu_account(struct tcb *task);
+
+
+/********************************************************
+ * Serial input module
+ ********************************************************/
+
+/* Receive errors reported by hal_uart_getc(), in PL011 data register order */
+#define UART_RX_FRAMING     (1u << 0)
+#define UART_RX_PARITY      (1u << 1)
+#define UART_RX_BREAK       (1u << 2)
+#define UART_RX_OVERRUN     (1u << 3)   // the FIFO was full: characters after this one were lost
+
+void _os_init_uart();		// Initialize timer management module
 
 
 /********************************************************
  * Lock module
  ********************************************************/
+
+/* Implementations that can back _os_spinlock_t */
+#define SPINLOCK_TAS      0     // test-and-set on a single word
+#define SPINLOCK_TICKET   1     // FIFO ticket lock
+#define SPINLOCK_MCS      2     // queued lock, each waiter spins on its own node
+
+#ifndef SPINLOCK_IMPL
+#define SPINLOCK_IMPL SPINLOCK_TICKET
+#endif
+
 #define SPINLOCK_UNLOCKED 0
 #define SPINLOCK_LOCKED   1
-typedef volatile int _os_spinlock_t;
+
+/* Deepest nesting of spinlocks on kernel paths (only _os_ready_queue_lock) */
+#define SPINLOCK_KERNEL_NESTING 1
+
+#if SPINLOCK_IMPL == SPINLOCK_MCS && EOS_CFG_SPINLOCK_NESTING < SPINLOCK_KERNEL_NESTING
+#error "EOS_CFG_SPINLOCK_NESTING is below the nesting of kernel spinlocks"
+#endif
+
+/* Test-and-set lock: SPINLOCK_UNLOCKED or SPINLOCK_LOCKED */
+typedef volatile int _os_taslock_t;
+
+/* Ticket lock: owner ticket in bits [15:0], next ticket in bits [31:16] */
+typedef volatile int32u_t _os_ticketlock_t;
+
+/* MCS queue node: one per waiting CPU */
+typedef struct _os_mcs_node {
+    struct _os_mcs_node *volatile next;
+    volatile int32u_t locked;
+    void *volatile lock;        // lock this node is queued on, NULL if unused
+} _os_mcs_node_t;
+
+/* MCS lock: tail of the waiter queue, NULL when unlocked */
+typedef _os_mcs_node_t *volatile _os_mcslock_t;
+
+#if SPINLOCK_IMPL == SPINLOCK_MCS
+typedef _os_mcslock_t _os_spinlock_t;
+#elif SPINLOCK_IMPL == SPINLOCK_TICKET
+typedef _os_ticketlock_t _os_spinlock_t;
+#else
+typedef _os_taslock_t _os_spinlock_t;
+#endif
+
+/* Lock with the implementation selected by SPINLOCK_IMPL */
 void _os_spin_lock(_os_spinlock_t *lock);
 void _os_spin_unlock(_os_spinlock_t *lock);
 
+/* Individual implementations: waiters sleep in WFE until the holder's
+ * release store clears their exclusive monitor */
+void _os_tas_lock(_os_taslock_t *lock);
+void _os_tas_unlock(_os_taslock_t *lock);
+void _os_ticket_lock(_os_ticketlock_t *lock);
+void _os_ticket_unlock(_os_ticketlock_t *lock);
+void _os_mcs_lock(_os_mcslock_t *lock, _os_mcs_node_t *node);
+void _os_mcs_unlock(_os_mcslock_t *lock, _os_mcs_node_t *node);
+
+/* Atomic operations on a 32-bit word (acquire-release ordering)
+ * Both return the value observed before the operation */
+int32s_t _os_atomic_cas(volatile int32s_t *ptr, int32s_t expected, int32s_t desired);
+int32s_t _os_atomic_fetch_add(volatile int32s_t *ptr, int32s_t delta);
+
 /********************************************************
  * Common utility module
  ********************************************************/
@@ -53,24 +137,55 @@ typedef struct _os_node {
 /* Adds the specified node at the end (tail) of the list */
 void _os_add_node_tail(_os_node_t **head, _os_node_t *new_node);
 
+/* Adds the specified node at the front (head) of the list */
+void _os_add_node_head(_os_node_t **head, _os_node_t *new_node);
+
 /* Adds the specified node by its priority */
 void _os_add_node_ordered(_os_node_t **head, _os_node_t *new_node);
 
 /* Removes a node from the list */
 int32u_t _os_remove_node(_os_node_t **head, _os_node_t *node);
 
-/* Formatted output conversion */
-int32s_t vsprintf(char *buf, const char *fmt, va_list args);
+/* Memory copy and fill (hal/<HAL>/string.*): same contract as the libc
+ * functions, safe inside interrupt handlers */
+void *_os_memcpy(void *dst, const void *src, size_t n);
+void *_os_memmove(void *dst, const void *src, size_t n);
+void *_os_memset(void *dst, int32s_t val, size_t n);
+
+/* Formatted output conversion: the text is handed to sink(ctx, s, n) in
+ * pieces as it is produced; returns the number of characters */
+typedef void (*_os_print_sink_t)(void *ctx, const char *s, size_t n);
+int32s_t _os_vformat(_os_print_sink_t sink, void *ctx, const char *fmt, va_list args);
 
 void _os_serial_puts(const char *s);
 
 
+/********************************************************
+ * Synchronization module
+ ********************************************************/
+
+/* Puts a semaphore of a wait set on the set's ready list, see eos_select() */
+struct eos_semaphore;
+void _os_select_signal(struct eos_semaphore *sem);
+
+
+/********************************************************
+ * Block device module
+ ********************************************************/
+
+void _os_init_blk();
+
+/* Called by the HAL, in interrupt context, for each finished request;
+ * tag is what hal_blk_enqueue() was given */
+void _os_blk_complete(void *tag, int8u_t status);
+
+
 /********************************************************
  * Interrupt management module
  ********************************************************/
 
 /* Maximum number of IRQs */
-#define IRQ_MAX 32
+#define IRQ_MAX EOS_CFG_IRQ_MAX
 
 /* The common interrupt handler:
  * 	Invoked by HAL whenever an interrupt occurrs.
@@ -89,21 +204,80 @@ void _os_init_timer();
  * Task management module
  ********************************************************/
 
-void _os_wait_in_queue(_os_node_t **wait_queue, int8u_t queue_type);
-void _os_wakeup_from_queue(_os_node_t **wait_queue);
-void _os_wakeup_all_from_queue(_os_node_t **wait_queue);
+/* Task states (tcb->status) */
+#define READY		    1
+#define RUNNING		    2
+#define WAITING		    3
+#define SUSPENDED       4
+
+/* Fill byte of unused stack, see eos_get_stack_usage() */
+#define STACK_FILL      0xA5
+
+/*
+ * Level block of a PRIORITY wait queue: one FIFO of waiting tasks per
+ * priority level and a bitmap of the non-empty levels, as the ready
+ * queue, so that a task is queued and the highest waiter found in
+ * constant time
+ */
+typedef struct _os_wait_levels {
+    _os_node_t *level[EOS_CFG_LOWEST_PRIORITY + 1];
+    int8u_t group;
+    int8u_t table[EOS_CFG_LOWEST_PRIORITY / 8 + 1];
+    struct _os_wait_levels *next_free;
+} _os_wait_levels_t;
+
+/*
+ * Wait queue: a FIFO queue is a plain list of waiting tasks. A PRIORITY
+ * queue borrows a level block from a pool of EOS_CFG_WAIT_LEVEL_BLOCKS
+ * when its first task blocks and returns it when the last one leaves;
+ * while the pool is empty it keeps the tasks in a list ordered by
+ * priority instead. A queued task's priority is in its queue_node.order_val.
+ */
+typedef struct _os_wait_queue {
+    _os_node_t *head;           // waiting tasks, unless levels is set
+    _os_wait_levels_t *levels;  // waiting tasks of a PRIORITY queue, NULL if none
+    int8u_t queue_type;         // 0: FIFO, 1: priority
+} _os_wait_queue_t;
+
+void _os_init_wait_queue(_os_wait_queue_t *wait_queue, int8u_t queue_type);
+
+/* 1 if a task is waiting */
+static inline int32u_t _os_has_waiters(const _os_wait_queue_t *wait_queue)
+{
+    return wait_queue->head != NULL || wait_queue->levels != NULL;
+}
+
+/* Number of waiting tasks; walks the lists */
+int32u_t _os_wait_queue_length(_os_wait_queue_t *wait_queue);
+
+void _os_wait_in_queue(_os_wait_queue_t *wait_queue);
+void _os_wakeup_from_queue(_os_wait_queue_t *wait_queue);
+void _os_wakeup_all_from_queue(_os_wait_queue_t *wait_queue);
 void _os_wakeup_from_alarm_queue(void *arg);
 
+/* Counts down the running task's time slice; called on every system tick */
+void _os_tick_time_slice(void);
+
+/*
+ * Bracket interrupt handling: CPU time accounting, and rescheduling
+ * deferred until the handler is done
+ *     frame: context the HAL saved for the interrupted task, or 0 if
+ *         eos_schedule() has to save it with _os_save_context()
+ */
+void _os_irq_enter(addr_t frame);
+void _os_irq_exit(void);
+
 
 /********************************************************
  * Scheduler module
  ********************************************************/
 
-#define LOWEST_PRIORITY		63
-#define MEDIUM_PRIORITY		32
+#define LOWEST_PRIORITY		EOS_CFG_LOWEST_PRIORITY
+#define MEDIUM_PRIORITY		((LOWEST_PRIORITY + 1) / 2)
 #define READY_TABLE_SIZE	(LOWEST_PRIORITY / 8 + 1)
 #define LOCKED			1
 #define UNLOCKED		0
+#define DEFAULT_TIME_SLICE	EOS_CFG_DEFAULT_TIME_SLICE
 
 /* Scheduler lock */
 extern int8u_t _os_scheduler_lock;
@@ -116,6 +290,10 @@ void _os_restore_scheduler(int8u_t);
 int32u_t _os_lock_sync(_os_spinlock_t *lock);
 void _os_unlock_sync(int32u_t flag, _os_spinlock_t *lock);
 
+/* _os_map_table[i] = 1 << i; _os_unmap_table[v] = lowest set bit of v (8 bits) */
+extern int8u_t const _os_map_table[];
+extern int8u_t const _os_unmap_table[];
+
 /* Gets the highest-prioity task from the ready list */
 int32u_t _os_get_highest_priority();
 
@@ -147,12 +325,15 @@ addr_t _os_create_context(addr_t stack_base, size_t stack_size, void (*entry)(vo
  *         it returns the address of the saved context
  *     Second, it returns via the saved task
  *         it returns 0 (NULL)
+ * A HAL may implement it as a macro expanding in the caller's frame
  */
-// addr_t _os_save_context();
+#ifndef _os_save_context
+addr_t _os_save_context();
+#endif
 
 /**
- * Restores CPU registers of a given context
+ * Restores CPU registers of a given context and resumes it
  */
-// void _os_restore_context(addr_t sp);
+void _os_restore_and_eret(addr_t sp);
 
 #endif /* EOS_INTERNAL_H */
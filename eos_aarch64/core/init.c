@@ -12,25 +12,33 @@
 
 static void _os_idle_task(void *arg);	// idle task
 static eos_tcb_t idle_task;		// tcb for the idle task
-static int8u_t idle_stack[8096];	// stack for the idle task
+static int8u_t idle_stack[EOS_CFG_IDLE_STACK_SIZE];	// stack for the idle task
 
 
 /*
  * This function is called by HAL after initializing H/W
  */
-void _os_init() //초기화 함수로, hal의 entry.S에서 호출됨
+_OS_COLD void _os_init() //초기화 함수로, hal의 entry.S에서 호출됨
 {
     // Interrupts and preemption must be disabled during initialziation
     hal_disable_interrupt(); // hal/interrupt_asm.s에 구현되어 있음. // 확인 완료(25/09/07-이종원)
     _os_scheduler_lock = LOCKED; //eos_internal.h에 int8u_t로 선언되어 있음 + scheduler.c에 정의되어 있음 // 확인 완료(25/09/07-이종원)
 
     // Initializes subsystems
-    _gic_init();
-    _os_init_hal(); // timer interrupt 만 활성화함
+    _os_init_hal(); // interrupt controller 초기화 후 timer interrupt 만 활성화함
+#if EOS_CFG_PMU
+    _os_init_pmu();
+#endif
     _os_init_icb_table(); //core/interrupt.c에 구현되어 있음 - Team A 관할 // 확인 완료(25/09/07-이종원)
     _os_init_scheduler(); // core/scheduler.c에 구현되어 있음 - Team A 관할 //확인 완료 (25/09/07-이종원)
     _os_init_task(); // core/task.c에 구현되어 있음 - Team A 관할 //확인 완료 (25/09/07-이종원)
     _os_init_timer(); // core/timer.c에 구현되어 있음 - Team A 관할 //진행중 (25/09/07-이종원)
+#if EOS_CFG_UART_RX
+    _os_init_uart();
+#endif
+#if EOS_CFG_BLK
+    _os_init_blk();
+#endif
 
     // Creates an idle task
     PRINT("Creating an idle task\n");
@@ -53,6 +61,12 @@ void _os_init() //초기화 함수로, hal의 entry.S에서 호출됨
 }
 
 
+eos_tcb_t *eos_get_idle_task()
+{
+    return &idle_task;
+}
+
+
 static void _os_idle_task(void *arg)
 {
     while (1) {
@@ -16,6 +16,11 @@ typedef struct icb { // 확인 완료(25/09/07-이종원)
     int8s_t irqnum;				// irq number
     void (*handler)(int8s_t irqnum, void *arg);	// the handler function //table에 시레로 호출될 함수의 주소를 저장
     void *arg;   // argument given to the handler when interrupt occurs
+    int32u_t count;     // times the irq was taken since boot
+#if EOS_CFG_THREADED_IRQ
+    eos_interrupt_handler_t bottom_half;    // deferred part run by the handler task, NULL if not threaded
+    eos_tcb_t *thread;                      // task that runs bottom_half
+#endif
 } _os_icb_t;
 
 /**
@@ -24,7 +29,7 @@ typedef struct icb { // 확인 완료(25/09/07-이종원)
 _os_icb_t _os_icb_table[IRQ_MAX]; //Interrupt Control Block이 IQR_MAX크기로 테이블에 저장된 형태
 
 
-void _os_init_icb_table() // 확인 완료(25/09/07-이종원)
+_OS_COLD void _os_init_icb_table() // 확인 완료(25/09/07-이종원)
 {
     PRINT("Initializing interrupt module\n");
 
@@ -33,86 +38,140 @@ void _os_init_icb_table() // 확인 완료(25/09/07-이종원)
         p->irqnum = i;
         p->handler = NULL;
         p->arg = NULL; 
+        p->count = 0;
+#if EOS_CFG_THREADED_IRQ
+        p->bottom_half = NULL;
+        p->thread = NULL;
+#endif
     }
 }
 
 
-static void copy_context(_os_context_t *dst, const _os_context_t *src)
+/* Runs the handler of one acknowledged irq */
+static inline void _os_dispatch_irq(int32u_t irq_num)
 {
-    if (!dst || !src) {
-        return;
-    }
-
-    int64u_t *dst_words = (int64u_t *)dst;
-    const int64u_t *src_words = (const int64u_t *)src;
-    const size_t word_count = sizeof(_os_context_t) / sizeof(int64u_t);
-    const int64u_t dst_addr = (int64u_t)dst;
-    const int64u_t src_addr = (int64u_t)src;
+    /* Acknowledges the irq */
+    hal_ack_irq(irq_num);
 
-    if (dst_addr == src_addr) {
-        return;
+    if (irq_num >= IRQ_MAX) {
+        return;             /* no ICB: only ended */
     }
 
-    if (dst_addr > src_addr && dst_addr < src_addr + sizeof(_os_context_t)) {
-        for (size_t i = word_count; i-- > 0;) {
-            dst_words[i] = src_words[i];
+    /* Dispatches the handler and call it */
+    _os_icb_t *p = &_os_icb_table[irq_num];
+    p->count++;
+#if EOS_CFG_THREADED_IRQ
+    if (p->thread != NULL) {
+        /* Threaded: masks the line until the bottom half has run */
+        hal_disable_irq_line(irq_num);
+        if (p->handler != NULL) {
+            p->handler(irq_num, p->arg);
         }
-        return;
+        eos_notify(p->thread, 0, NOTIFY_GIVE);
+    } else
+#endif
+    if (p->handler != NULL) {
+        p->handler(irq_num, p->arg); // timer_interrupt_handler 호출
     }
+}
+
+
+/*
+ * irq_num: the irq the HAL took on exception entry (never spurious)
+ * Every irq that became pending meanwhile is taken and handled in the
+ * same exception: one context save, one scheduling decision and one
+ * restore for the whole burst.
+ */
+_OS_HOT void _os_common_interrupt_handler(int32u_t irq_num, addr_t saved_context_ptr) {
+    int32s_t next;
+    PMU_BEGIN(pmu_start);
 
-    for (size_t i = 0; i < word_count; ++i) {
-        dst_words[i] = src_words[i];
+    /* From here on, time is charged as interrupt time and
+     * eos_schedule() only records the request */
+    _os_irq_enter(saved_context_ptr);
+
+    _os_dispatch_irq(irq_num);
+    while ((next = hal_get_irq()) >= 0) {
+        _os_dispatch_irq((int32u_t)next);
     }
+
+    PMU_END(eos_pmu_irq, pmu_start);
+
+    /* Switches tasks if a handler asked for it, or returns to the interrupted task */
+    _os_irq_exit();
 }
 
-void save_current_task_sp(addr_t sp)
+
+int8s_t eos_set_interrupt_handler(int8s_t irqnum, eos_interrupt_handler_t handler, void *arg)
 {
-    eos_tcb_t *tcb = eos_get_current_task();
-    if (!tcb) {
-        return;
+    /* Validate parameters: irq range and optional handler (NULL = unregister) */
+    if (irqnum < 0 || irqnum >= IRQ_MAX) {
+        PRINT("invalid irqnum=%d\n", (int32u_t)irqnum);
+        return -1; /* EINVAL */
     }
 
-    _os_context_t *dest = (_os_context_t *)tcb->sp;
-    const _os_context_t *src = (const _os_context_t *)sp;
+    PRINT("irqnum: %d, handler: %p, arg: %p\n", (int32u_t)irqnum, (void*)handler, arg);
 
-    if (!dest) {
-        return;
-    }
+    _os_icb_t *p = &_os_icb_table[irqnum];
+    p->handler = handler; /* NULL means unregister */
+    p->arg = arg;
+#if EOS_CFG_THREADED_IRQ
+    p->thread = NULL;       /* Back to a plain handler; a handler task stays parked */
+#endif
 
-    copy_context(dest, src);
+    return 0;
 }
 
-// aarch64
-void _os_common_interrupt_handler(int32u_t irq_num, addr_t saved_context_ptr) {
 
-    /* Acknowledges the irq */
-    hal_ack_irq(irq_num);
+#if EOS_CFG_THREADED_IRQ
+/* Body of a threaded handler task: one bottom half per notification */
+static void _os_irq_thread(void *arg)
+{
+    _os_icb_t *p = (_os_icb_t *)arg;
 
-    /* Dispatches the handler and call it */
-    _os_icb_t *p = &_os_icb_table[irq_num];
-    if (p->handler != NULL) {
-        save_current_task_sp(saved_context_ptr);
-        p->handler(irq_num, p->arg); // timer_interrupt_handler 호출
+    while (1) {
+        eos_take_notification(1, 0);
+        p->bottom_half(p->irqnum, p->arg);
+        hal_enable_irq_line(p->irqnum);
     }
 }
 
 
-int8s_t eos_set_interrupt_handler(int8s_t irqnum, eos_interrupt_handler_t handler, void *arg)
+int8s_t eos_set_threaded_interrupt_handler(int8s_t irqnum,
+		eos_interrupt_handler_t top_half, eos_interrupt_handler_t bottom_half,
+		void *arg, struct tcb *task, addr_t sblock_start, size_t sblock_size,
+		int32u_t priority)
 {
-    /* Validate parameters: irq range and optional handler (NULL = unregister) */
     if (irqnum < 0 || irqnum >= IRQ_MAX) {
         PRINT("invalid irqnum=%d\n", (int32u_t)irqnum);
         return -1; /* EINVAL */
     }
+    if (bottom_half == NULL || task == NULL) {
+        PRINT("bottom half(%p) and task(%p) are required\n", (void*)bottom_half, (void*)task);
+        return -1;
+    }
 
-    PRINT("irqnum: %d, handler: %p, arg: %p\n", (int32u_t)irqnum, (void*)handler, arg);
+    PRINT("irqnum: %d, top: %p, bottom: %p, priority: %u\n",
+          (int32u_t)irqnum, (void*)top_half, (void*)bottom_half, priority);
 
     _os_icb_t *p = &_os_icb_table[irqnum];
-    p->handler = handler; /* NULL means unregister */
+    p->bottom_half = bottom_half;
+
+    /* The task waits for its first notification before the irq is routed to it */
+    if (eos_create_task(task, sblock_start, sblock_size, _os_irq_thread, p, priority)) {
+        p->bottom_half = NULL;
+        return -1;
+    }
+
+    int32u_t flag = hal_disable_interrupt();
+    p->handler = top_half;
     p->arg = arg;
+    p->thread = task;
+    hal_restore_interrupt(flag);
 
     return 0;
 }
+#endif
 
 
 eos_interrupt_handler_t eos_get_interrupt_handler(int8s_t irqnum)
@@ -124,4 +183,13 @@ eos_interrupt_handler_t eos_get_interrupt_handler(int8s_t irqnum)
 
     _os_icb_t *p = &_os_icb_table[irqnum];
     return p->handler;
+}
+
+
+int32u_t eos_get_irq_count(int8s_t irqnum)
+{
+    if (irqnum < 0 || irqnum >= IRQ_MAX) {
+        return 0;
+    }
+    return _os_icb_table[irqnum].count;
 }	
@@ -0,0 +1,106 @@
+/********************************************************
+ * Filename: core/pmu.c
+ *
+ * Description: PMU event counters per task and per kernel path
+ *     The HAL counts cycles, instructions, L1D refills and branch
+ *     mispredicts. Time accounting on each switch and interrupt entry
+ *     charges the counts since the previous stamp to the running task;
+ *     probes sum the deltas of bracketed code paths. Together they show
+ *     whether a path is bound by cache misses or by mispredicts.
+ ********************************************************/
+
+#include <core/eos.h>
+
+#if EOS_CFG_PMU
+
+eos_pmu_probe_t eos_pmu_schedule;
+eos_pmu_probe_t eos_pmu_send;
+eos_pmu_probe_t eos_pmu_irq;
+
+static eos_pmu_probe_t *_os_pmu_probes;
+static int32u_t _os_pmu_last[PMU_COUNTERS];    // reading at the last _os_pmu_account()
+
+
+_OS_HOT void eos_pmu_read(int32u_t counts[PMU_COUNTERS])
+{
+    hal_pmu_read(counts);
+}
+
+
+_OS_HOT void eos_pmu_add(eos_pmu_probe_t *probe, const int32u_t start[PMU_COUNTERS])
+{
+    int32u_t now[PMU_COUNTERS];
+    int32u_t flag;
+
+    hal_pmu_read(now);
+
+    flag = hal_disable_interrupt();
+    for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+        probe->count[i] += now[i] - start[i];
+    }
+    probe->calls++;
+    hal_restore_interrupt(flag);
+}
+
+
+/* Called with interrupts off */
+_OS_HOT void _os_pmu_account(eos_tcb_t *task)
+{
+    int32u_t now[PMU_COUNTERS];
+
+    hal_pmu_read(now);
+    for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+        if (task) {
+            task->pmu[i] += now[i] - _os_pmu_last[i];
+        }
+        _os_pmu_last[i] = now[i];
+    }
+}
+
+
+void eos_pmu_init_probe(eos_pmu_probe_t *probe, const char *name)
+{
+    if (probe == NULL) {
+        PRINT("probe is NULL\n");
+        return;
+    }
+
+    int32u_t flag = hal_disable_interrupt();
+
+    probe->name = name;
+    probe->calls = 0;
+    for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+        probe->count[i] = 0;
+    }
+    for (eos_pmu_probe_t *p = _os_pmu_probes; p; p = p->next) {
+        if (p == probe) {
+            hal_restore_interrupt(flag);
+            return;         // already listed: only reset
+        }
+    }
+    probe->next = _os_pmu_probes;
+    _os_pmu_probes = probe;
+    hal_restore_interrupt(flag);
+}
+
+
+eos_pmu_probe_t *eos_pmu_get_probes(void)
+{
+    return _os_pmu_probes;
+}
+
+
+_OS_COLD void _os_init_pmu()
+{
+    PRINT("Initializing PMU\n");
+
+    int32u_t n = hal_pmu_init();
+    PRINT("%u of %u counters available\n", n, PMU_COUNTERS);
+
+    hal_pmu_read(_os_pmu_last);
+    eos_pmu_init_probe(&eos_pmu_irq, "irq");
+    eos_pmu_init_probe(&eos_pmu_send, "send_message");
+    eos_pmu_init_probe(&eos_pmu_schedule, "schedule");
+}
+
+#endif
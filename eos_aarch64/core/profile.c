@@ -0,0 +1,124 @@
+/********************************************************
+ * Filename: core/profile.c
+ *
+ * Description: Statistical PC sampling profiler
+ *     Each sample is the PC the interrupt stopped and the task that was
+ *     running, taken from the system tick or from the HAL profiling
+ *     timer at its own rate. Samples go to a ring; eos_profile_dump()
+ *     prints it and profile.sh turns the log into flat per-function and
+ *     per-task profiles against the eos ELF.
+ ********************************************************/
+
+#include <core/eos.h>
+
+#if EOS_CFG_PROFILE
+
+#define PROFILE_RING_SIZE   EOS_CFG_PROFILE_SAMPLES
+#define PROFILE_RING_MASK   (PROFILE_RING_SIZE - 1)
+
+#define PROFILE_OFF         0
+#define PROFILE_TICK        1   // sampled by the system tick
+#define PROFILE_TIMER       2   // sampled by IRQ_PROFILE
+
+typedef struct _os_profile_sample {
+    addr_t pc;
+    eos_tcb_t *task;
+} _os_profile_sample_t;
+
+/* Global so that a memory dump of the image can also be decoded */
+_os_profile_sample_t _os_profile_ring[PROFILE_RING_SIZE];
+static volatile int32u_t _os_profile_count;     // free-running: samples taken
+static volatile int8u_t _os_profile_mode;
+
+
+/* Called in interrupt context */
+static _OS_HOT void _os_profile_sample(void)
+{
+    _os_profile_sample_t *s = &_os_profile_ring[_os_profile_count & PROFILE_RING_MASK];
+
+    s->pc = hal_irq_pc();
+    s->task = eos_get_current_task();
+    _os_profile_count++;
+}
+
+
+void _os_profile_tick(void)
+{
+    if (_os_profile_mode == PROFILE_TICK) {
+        _os_profile_sample();
+    }
+}
+
+
+static void _os_profile_handler(int8s_t irqnum, void *arg)
+{
+    hal_profile_timer_rearm();
+    if (_os_profile_mode == PROFILE_TIMER) {
+        _os_profile_sample();
+    }
+}
+
+
+void eos_profile_start(int32u_t hz)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    if (_os_profile_mode == PROFILE_TIMER) {
+        hal_profile_timer_stop();
+    }
+    _os_profile_count = 0;
+
+    if (hz == 0) {
+        _os_profile_mode = PROFILE_TICK;
+    } else {
+        eos_set_interrupt_handler(IRQ_PROFILE, _os_profile_handler, NULL);
+        _os_profile_mode = PROFILE_TIMER;
+        hal_profile_timer_start(hz);
+    }
+    hal_restore_interrupt(flag);
+}
+
+
+void eos_profile_stop(void)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    if (_os_profile_mode == PROFILE_TIMER) {
+        hal_profile_timer_stop();
+        eos_set_interrupt_handler(IRQ_PROFILE, NULL, NULL);
+    }
+    _os_profile_mode = PROFILE_OFF;
+    hal_restore_interrupt(flag);
+}
+
+
+/*
+ * Prints the ring, oldest sample first:
+ *     PROF begin samples=<taken> kept=<in ring> anchor=<&eos_profile_dump>
+ *     PROF <pc> <task>
+ *     PROF end
+ * The anchor lets profile.sh relocate a position-independent image.
+ * Sampling is paused meanwhile, so the ring does not move under the dump.
+ */
+void eos_profile_dump(void)
+{
+    int32u_t flag = hal_disable_interrupt();
+    int8u_t mode = _os_profile_mode;
+    int32u_t count = _os_profile_count;
+    int32u_t kept = (count < PROFILE_RING_SIZE) ? count : PROFILE_RING_SIZE;
+
+    _os_profile_mode = PROFILE_OFF;
+    hal_restore_interrupt(flag);
+
+    eos_printf("PROF begin samples=%u kept=%u anchor=0x%lx\n", count, kept,
+               (unsigned long)(addr_t)eos_profile_dump);
+    for (int32u_t i = count - kept; i != count; i++) {
+        _os_profile_sample_t *s = &_os_profile_ring[i & PROFILE_RING_MASK];
+        eos_printf("PROF 0x%lx 0x%lx\n", (unsigned long)s->pc, (unsigned long)s->task);
+    }
+    eos_printf("PROF end\n");
+
+    _os_profile_mode = mode;
+}
+
+#endif
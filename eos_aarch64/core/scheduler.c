@@ -66,20 +66,20 @@ void _os_restore_scheduler(int8u_t scheduler_state)
     eos_schedule();
 }
 
-int32u_t _os_lock_sync(_os_spinlock_t *lock)
+_OS_HOT int32u_t _os_lock_sync(_os_spinlock_t *lock)
 {
     int32u_t flag = hal_disable_interrupt();
     _os_spin_lock(lock);
     return flag;
 }
 
-void _os_unlock_sync(int32u_t flag, _os_spinlock_t *lock)
+_OS_HOT void _os_unlock_sync(int32u_t flag, _os_spinlock_t *lock)
 {
     _os_spin_unlock(lock);
     hal_restore_interrupt(flag);
 }
 
-void _os_init_scheduler()
+_OS_COLD void _os_init_scheduler()
 {
     PRINT("Initializing scheduler module\n");
     // GEMINI: 해당부분은 없어도 문제 없다.
@@ -100,7 +100,7 @@ void _os_init_scheduler()
 }
 
 
-int32u_t _os_get_highest_priority()
+_OS_HOT int32u_t _os_get_highest_priority()
 {
     int8u_t y = _os_unmap_table[_os_ready_group];
 
@@ -108,7 +108,7 @@ int32u_t _os_get_highest_priority()
 }
 
 
-void _os_set_ready(int8u_t priority)
+_OS_HOT void _os_set_ready(int8u_t priority)
 {
     /* Sets corresponding bit of ready_group to 1 */
     _os_ready_group |= _os_map_table[priority >> 3];
@@ -118,7 +118,7 @@ void _os_set_ready(int8u_t priority)
 }
 
 
-void _os_unset_ready(int8u_t priority)
+_OS_HOT void _os_unset_ready(int8u_t priority)
 {
     /* Sets corresponding bit of ready_table to 0 */
     if ((_os_ready_table[priority >> 3] &= ~_os_map_table[priority & 0x07]) == 0) {
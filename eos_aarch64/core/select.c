@@ -0,0 +1,176 @@
+/********************************************************
+ * Filename: core/select.c
+ *
+ * Description: Waiting on several semaphores and message queues at once
+ *     A wait set keeps a list of members that gained a unit while no
+ *     task was blocked on them directly. eos_select() takes the oldest
+ *     entry that still has a unit; entries whose units were taken by
+ *     others are dropped on the way. A member is listed at most once;
+ *     every unit it gains wakes one task in eos_select(), so units
+ *     released while the member is still listed are not lost to
+ *     further selectors.
+ ********************************************************/
+
+#include <core/eos.h>
+
+#if EOS_CFG_SELECT
+
+void eos_init_waitset(eos_waitset_t *set)
+{
+    if (set == NULL) {
+        PRINT("set is NULL\n");
+        return;
+    }
+    set->ready = NULL;
+    _os_init_wait_queue(&set->wait_queue, FIFO);
+}
+
+
+/* Called with the semaphore's unit already counted */
+_OS_HOT void _os_select_signal(eos_semaphore_t *sem)
+{
+    int32u_t flag = hal_disable_interrupt();
+    eos_waitset_t *set = sem->set;
+
+    if (set) {
+        if (sem->set_node.next == NULL) {
+            _os_add_node_tail(&set->ready, &sem->set_node);
+        }
+        if (_os_has_waiters(&set->wait_queue)) {
+            _os_wakeup_from_queue(&set->wait_queue);
+        }
+    }
+    hal_restore_interrupt(flag);
+}
+
+
+static int32u_t _os_waitset_add(eos_waitset_t *set, eos_semaphore_t *sem, void *obj)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    if (sem->set != NULL && sem->set != set) {
+        hal_restore_interrupt(flag);
+        PRINT("%p already belongs to set %p\n", obj, (void*)sem->set);
+        return (int32u_t)-1;
+    }
+    sem->set = set;
+    sem->set_obj = obj;
+    hal_restore_interrupt(flag);
+
+    if (sem->count > 0) {
+        _os_select_signal(sem);
+    }
+    return 0;
+}
+
+
+static void _os_waitset_remove(eos_waitset_t *set, eos_semaphore_t *sem)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    if (sem->set == set) {
+        _os_remove_node(&set->ready, &sem->set_node);
+        sem->set = NULL;
+    }
+    hal_restore_interrupt(flag);
+}
+
+
+int32u_t eos_waitset_add_semaphore(eos_waitset_t *set, eos_semaphore_t *sem)
+{
+    if (set == NULL || sem == NULL) {
+        PRINT("invalid args set=%p sem=%p\n", (void*)set, (void*)sem);
+        return (int32u_t)-1;
+    }
+    return _os_waitset_add(set, sem, sem);
+}
+
+
+void eos_waitset_remove_semaphore(eos_waitset_t *set, eos_semaphore_t *sem)
+{
+    if (set == NULL || sem == NULL) {
+        PRINT("invalid args set=%p sem=%p\n", (void*)set, (void*)sem);
+        return;
+    }
+    _os_waitset_remove(set, sem);
+}
+
+
+#if EOS_CFG_MQUEUE
+/* A queue is ready while its receive semaphore has units (messages) */
+int32u_t eos_waitset_add_mqueue(eos_waitset_t *set, eos_mqueue_t *mq)
+{
+    if (set == NULL || mq == NULL) {
+        PRINT("invalid args set=%p mq=%p\n", (void*)set, (void*)mq);
+        return (int32u_t)-1;
+    }
+    return _os_waitset_add(set, &mq->getsem, mq);
+}
+
+
+void eos_waitset_remove_mqueue(eos_waitset_t *set, eos_mqueue_t *mq)
+{
+    if (set == NULL || mq == NULL) {
+        PRINT("invalid args set=%p mq=%p\n", (void*)set, (void*)mq);
+        return;
+    }
+    _os_waitset_remove(set, &mq->getsem);
+}
+#endif
+
+
+_OS_HOT void *eos_select(eos_waitset_t *set, int32s_t timeout)
+{
+    eos_counter_t *timer = eos_get_system_timer();
+    int32u_t deadline = timer->tick + (int32u_t)timeout;
+    eos_tcb_t *task = eos_get_current_task();
+    void *obj = NULL;
+
+#if EOS_CFG_ARG_CHECKS
+    if (set == NULL) {
+        PRINT("set is NULL\n");
+        return NULL;
+    }
+#endif
+
+    int32u_t flag = hal_disable_interrupt();
+
+    while (1) {
+        /* A member that still has units goes to the back, so that one
+         * busy member cannot hide the others */
+        while (set->ready) {
+            _os_node_t *node = set->ready;
+            eos_semaphore_t *sem = (eos_semaphore_t *)node->pnode;
+
+            _os_remove_node(&set->ready, node);
+            if (sem->count > 0) {
+                _os_add_node_tail(&set->ready, node);
+                obj = sem->set_obj;
+                break;
+            }
+        }
+        if (obj || timeout < 0) {
+            break;
+        }
+
+        int32s_t left = (int32s_t)(deadline - timer->tick);
+        if (timeout > 0 && left <= 0) {
+            break;
+        }
+        if (eos_get_scheduler_lock()) {
+            PRINT("Scheduler locked. eos_select() failed.\n");
+            break;
+        }
+
+        /* Woken by the first member that becomes ready, or by the alarm;
+         * either way the list is scanned again */
+        eos_set_alarm(timer, &task->alarm, (timeout > 0) ? (int32u_t)left : 0,
+                      _os_wakeup_from_alarm_queue, task);
+        _os_wait_in_queue(&set->wait_queue);
+    }
+
+    hal_restore_interrupt(flag);
+    return obj;
+}
+
+#endif
@@ -4,12 +4,57 @@
  * Author: Jiyong Park, RTOSLab. SNU
  * Modified by: Seongsoo Hong on 03/31/24
  *
- * Description: Routines for semaphores and condition variables
+ * Description: Routines for semaphores, condition variables, reader-writer locks
+ *              and task notifications
  ********************************************************/
 
 #include <core/eos.h>
 
-void eos_init_semaphore(eos_semaphore_t *sem, int8s_t initial_count, int8u_t queue_type)
+/*
+ * Semaphore count encoding:
+ *     count > 0: number of available units
+ *     count < 0: number of tasks that have claimed a unit and are blocked
+ * While no task is blocked, acquire and release only need a single
+ * atomic update of count and never touch the interrupt flag.
+ */
+
+/* Object that embeds the wait queue a task is blocked on */
+#define _OS_WAIT_OWNER(queue, type, member) \
+    ((type *)((int8u_t *)(queue) - __builtin_offsetof(type, member)))
+
+/* Takes a unit if one is available, without blocking */
+_OS_HOT static int32u_t _os_sem_try_down(eos_semaphore_t *sem)
+{
+    int32s_t old = sem->count;
+
+    while (old > 0) {
+        int32s_t seen = _os_atomic_cas(&sem->count, old, old - 1);
+        if (seen == old) {
+            return 1;
+        }
+        old = seen;
+    }
+    return 0;
+}
+
+
+/* Returns a unit if no task is blocked on the semaphore */
+_OS_HOT static int32u_t _os_sem_try_up(eos_semaphore_t *sem)
+{
+    int32s_t old = sem->count;
+
+    while (old >= 0) {
+        int32s_t seen = _os_atomic_cas(&sem->count, old, old + 1);
+        if (seen == old) {
+            return 1;
+        }
+        old = seen;
+    }
+    return 0;
+}
+
+
+void eos_init_semaphore(eos_semaphore_t *sem, int32s_t initial_count, int8u_t queue_type)
 {
     if (sem == NULL) {
         PRINT("semaphore is NULL\n");
@@ -17,18 +62,62 @@ void eos_init_semaphore(eos_semaphore_t *sem, int8s_t initial_count, int8u_t que
     }
     // To be filled by students: Project 4
     sem->count = initial_count;
-    sem->wait_queue = NULL;
-    sem->queue_type = queue_type;
+    _os_init_wait_queue(&sem->wait_queue, queue_type);
+#if EOS_CFG_SELECT
+    sem->set = NULL;
+    sem->set_obj = sem;
+    sem->set_node.pnode = sem;
+    sem->set_node.next = NULL;
+    sem->set_node.prev = NULL;
+#endif
 }
 
 
-int32u_t eos_acquire_semaphore(eos_semaphore_t *sem, int32s_t timeout)
+/*
+ * Alarm handler of a blocked acquire (interrupts disabled): the task
+ * leaves the wait queue and gives back its claim in the same step, so
+ * that count never includes the claim of a task no longer waiting
+ */
+static void _os_sem_timeout(void *arg)
+{
+    eos_tcb_t *task = (eos_tcb_t *)arg;
+    _os_wait_queue_t *queue = task->wait_queue_owner;
+
+    _os_wakeup_from_alarm_queue(task);
+    if (queue == NULL) {
+        return;
+    }
+
+    eos_semaphore_t *sem = _OS_WAIT_OWNER(queue, eos_semaphore_t, wait_queue);
+#if EOS_CFG_SELECT
+    if (_os_atomic_fetch_add(&sem->count, 1) >= 0 && sem->set) {
+        _os_select_signal(sem);
+    }
+#else
+    _os_atomic_fetch_add(&sem->count, 1);
+#endif
+}
+
+
+_OS_HOT int32u_t eos_acquire_semaphore(eos_semaphore_t *sem, int32s_t timeout)
 {
     // To be filled by students: Project 4
+#if EOS_CFG_ARG_CHECKS
     if (sem == NULL) {
         PRINT("semaphore is NULL\n");
         return 0;
     }
+#endif
+
+    /* Fast path: the semaphore is free */
+    if (_os_sem_try_down(sem)) {
+        return 1;
+    }
+
+    /* The semaphore is already locked */
+    if (timeout < 0) {
+        return 0;
+    }
 
     /* Check if the scheduler is locked */
     if (eos_get_scheduler_lock()) {
@@ -36,64 +125,64 @@ int32u_t eos_acquire_semaphore(eos_semaphore_t *sem, int32s_t timeout)
         return 0;
     }
 
-    /* Obtain the timeout point in the absolute time scale */
-    int32u_t abs_timeout = eos_get_system_timer()->tick + (int32u_t) timeout;
-
     int32u_t flag = hal_disable_interrupt();
-    if (sem->count <= 0) {
-        /* The semaphore is already locked */
-        if (timeout < 0) {
-            hal_restore_interrupt(flag);
-            return 0;
-        }
-        eos_set_alarm(eos_get_system_timer(),
-                      &eos_get_current_task()->alarm,
-                      (int32u_t) timeout, _os_wakeup_from_alarm_queue,
-                      eos_get_current_task());
-        do {
-            hal_restore_interrupt(flag);
-            _os_wait_in_queue(&sem->wait_queue, sem->queue_type);
 
-            if (timeout != 0 && abs_timeout <= eos_get_system_timer()->tick) {
-                /* This task is waken up by alarm */
-                return 0;
-            }
-
-            flag = hal_disable_interrupt();
-         } while (sem->count <= 0);
-
-         /* Remove the alarm (This task is waken up by another task) */
-         eos_set_alarm(eos_get_system_timer(),
-                       &eos_get_current_task()->alarm, 0, NULL, NULL);
+    /* Claims a unit; a negative count tells releasers that a task is waiting */
+    if (_os_atomic_fetch_add(&sem->count, -1) > 0) {
+        /* A unit was released in the meantime */
+        hal_restore_interrupt(flag);
+        return 1;
     }
 
-    sem->count--;
+    eos_tcb_t *task = eos_get_current_task();
+    eos_set_alarm(eos_get_system_timer(), &task->alarm,
+                  (int32u_t) timeout, _os_sem_timeout, task);
+    _os_wait_in_queue(&sem->wait_queue);
     hal_restore_interrupt(flag);
 
-    return 1;
-
+    /* 1: the releasing task handed its unit directly over to this task,
+     * 0: timed out, the claim was given back by _os_sem_timeout() */
+    return (int32u_t) task->wait_result;
 }
 
 
-void eos_release_semaphore(eos_semaphore_t *sem)
+_OS_HOT void eos_release_semaphore(eos_semaphore_t *sem)
 {
     // To be filled by students: Project 4
+#if EOS_CFG_ARG_CHECKS
     if (sem == NULL) {
         PRINT("semaphore is NULL\n");
         return;
     }
-    
-    int32u_t flag = hal_disable_interrupt();
-    sem->count++;
-    hal_restore_interrupt(flag);
-    if(sem->wait_queue) {
-            /* Select a task from the wait queue and make it ready */
-            _os_wakeup_from_queue(&sem->wait_queue);
+#endif
+
+    /* Fast path: no task is blocked on the semaphore */
+    if (_os_sem_try_up(sem)) {
+#if EOS_CFG_SELECT
+        if (sem->set) {
+            _os_select_signal(sem);
+        }
+#endif
+        return;
     }
 
+    int32u_t flag = hal_disable_interrupt();
+    if (_os_atomic_fetch_add(&sem->count, 1) < 0 && _os_has_waiters(&sem->wait_queue)) {
+        /* Hands the unit to the selected waiter, which returns without re-contending.
+         * Claims are queued and given back with interrupts disabled, so a
+         * negative count always has a waiter behind it. */
+        _os_wakeup_from_queue(&sem->wait_queue);
+    }
+#if EOS_CFG_SELECT
+    else if (sem->set) {
+        _os_select_signal(sem);
+    }
+#endif
+    hal_restore_interrupt(flag);
 }
 
 
+#if EOS_CFG_CONDITION
 /**
  * Condition variables are not covery in the OS course
  */
@@ -105,8 +194,7 @@ void eos_init_condition(eos_condition_t *cond, int32u_t queue_type)
         return;
     }
 
-    cond->wait_queue = NULL;
-    cond->queue_type = queue_type;
+    _os_init_wait_queue(&cond->wait_queue, (int8u_t)queue_type);
 }
 
 
@@ -120,7 +208,7 @@ void eos_wait_condition(eos_condition_t *cond, eos_semaphore_t *mutex)
     /* Releases acquired semaphore */
     eos_release_semaphore(mutex);
     /* Waits on condition's wait_queue */
-    _os_wait_in_queue(&cond->wait_queue, cond->queue_type);
+    _os_wait_in_queue(&cond->wait_queue);
     /* Acquires semaphore before returns */
     eos_acquire_semaphore(mutex, 0);
 }
@@ -136,6 +224,322 @@ void eos_notify_condition(eos_condition_t *cond)
     /* Selects a task in wait_queue and wake it up */
     _os_wakeup_from_queue(&cond->wait_queue);
 }
+#endif
+
+
+#if EOS_CFG_RWLOCK
+/**
+ * Reader-writer locks
+ *     Readers and writers take a free lock with a single CAS on state.
+ *     Blocked tasks are handed the lock by the releasing task:
+ *     a writer gets state = -1, all waiting readers are admitted at once.
+ */
+
+/* Readers may enter unless a writer holds the lock or has precedence */
+static int32u_t _os_rw_try_read(eos_rwlock_t *rw)
+{
+    int32s_t old = rw->state;
+
+    while (old >= 0 && !(rw->prefer_writer && rw->waiting_writers)) {
+        int32s_t seen = _os_atomic_cas(&rw->state, old, old + 1);
+        if (seen == old) {
+            return 1;
+        }
+        old = seen;
+    }
+    return 0;
+}
+
+
+static int32u_t _os_rw_try_write(eos_rwlock_t *rw)
+{
+    return _os_atomic_cas(&rw->state, 0, -1) == 0;
+}
+
+
+/* Admits every waiting reader while no writer holds the lock;
+ * called with interrupts disabled */
+static void _os_rw_admit_readers(eos_rwlock_t *rw)
+{
+    int32s_t readers = (int32s_t)_os_wait_queue_length(&rw->read_queue);
+
+    _os_atomic_fetch_add(&rw->state, readers);
+    _os_wakeup_all_from_queue(&rw->read_queue);
+}
+
+
+/* Passes a lock held with state == -1 to the next owner;
+ * called with interrupts disabled */
+static void _os_rw_handoff(eos_rwlock_t *rw)
+{
+    if (_os_has_waiters(&rw->write_queue) && (rw->prefer_writer || !_os_has_waiters(&rw->read_queue))) {
+        /* state stays -1 for the next writer */
+        rw->waiting_writers--;
+        _os_wakeup_from_queue(&rw->write_queue);
+    } else if (_os_has_waiters(&rw->read_queue)) {
+        rw->state = 0;
+        _os_rw_admit_readers(rw);
+    } else {
+        rw->state = 0;
+    }
+}
+
+
+/* Alarm handler of a blocked writer (interrupts disabled): it stops
+ * counting as waiting when it leaves the queue, and readers it held back
+ * may enter at once */
+static void _os_rw_write_timeout(void *arg)
+{
+    eos_tcb_t *task = (eos_tcb_t *)arg;
+    _os_wait_queue_t *queue = task->wait_queue_owner;
+
+    _os_wakeup_from_alarm_queue(task);
+    if (queue == NULL) {
+        return;
+    }
+
+    eos_rwlock_t *rw = _OS_WAIT_OWNER(queue, eos_rwlock_t, write_queue);
+    rw->waiting_writers--;
+    if (rw->waiting_writers == 0 && rw->state >= 0 && _os_has_waiters(&rw->read_queue)) {
+        _os_rw_admit_readers(rw);
+    }
+}
+
+
+void eos_init_rwlock(eos_rwlock_t *rw, int8u_t queue_type, int8u_t prefer_writer)
+{
+    if (rw == NULL) {
+        PRINT("rwlock is NULL\n");
+        return;
+    }
+
+    rw->state = 0;
+    rw->waiting_writers = 0;
+    _os_init_wait_queue(&rw->read_queue, queue_type);
+    _os_init_wait_queue(&rw->write_queue, queue_type);
+    rw->prefer_writer = prefer_writer;
+}
+
+
+int32u_t eos_acquire_read(eos_rwlock_t *rw, int32s_t timeout)
+{
+#if EOS_CFG_ARG_CHECKS
+    if (rw == NULL) {
+        PRINT("rwlock is NULL\n");
+        return 0;
+    }
+#endif
+
+    /* Fast path: no writer holds or waits for the lock */
+    if (_os_rw_try_read(rw)) {
+        return 1;
+    }
+    if (timeout < 0) {
+        return 0;
+    }
+    if (eos_get_scheduler_lock()) {
+        PRINT("Scheduler locked. eos_acquire_read() failed.\n");
+        return 0;
+    }
+
+    int32u_t flag = hal_disable_interrupt();
+    if (_os_rw_try_read(rw)) {
+        hal_restore_interrupt(flag);
+        return 1;
+    }
+
+    eos_tcb_t *task = eos_get_current_task();
+    eos_set_alarm(eos_get_system_timer(), &task->alarm,
+                  (int32u_t) timeout, _os_wakeup_from_alarm_queue, task);
+    _os_wait_in_queue(&rw->read_queue);
+    hal_restore_interrupt(flag);
+
+    /* The releasing task has already counted this reader in state */
+    return (int32u_t) task->wait_result;
+}
+
+
+void eos_release_read(eos_rwlock_t *rw)
+{
+#if EOS_CFG_ARG_CHECKS
+    if (rw == NULL) {
+        PRINT("rwlock is NULL\n");
+        return;
+    }
+#endif
+
+    if (_os_atomic_fetch_add(&rw->state, -1) != 1 || !_os_has_waiters(&rw->write_queue)) {
+        return;
+    }
+
+    /* The last reader leaves while a writer is waiting */
+    int32u_t flag = hal_disable_interrupt();
+    if (_os_rw_try_write(rw)) {
+        _os_rw_handoff(rw);
+    }
+    hal_restore_interrupt(flag);
+}
+
+
+int32u_t eos_acquire_write(eos_rwlock_t *rw, int32s_t timeout)
+{
+#if EOS_CFG_ARG_CHECKS
+    if (rw == NULL) {
+        PRINT("rwlock is NULL\n");
+        return 0;
+    }
+#endif
+
+    /* Fast path: the lock is free */
+    if (_os_rw_try_write(rw)) {
+        return 1;
+    }
+    if (timeout < 0) {
+        return 0;
+    }
+    if (eos_get_scheduler_lock()) {
+        PRINT("Scheduler locked. eos_acquire_write() failed.\n");
+        return 0;
+    }
+
+    int32u_t flag = hal_disable_interrupt();
+    if (_os_rw_try_write(rw)) {
+        hal_restore_interrupt(flag);
+        return 1;
+    }
+
+    eos_tcb_t *task = eos_get_current_task();
+    rw->waiting_writers++;
+    eos_set_alarm(eos_get_system_timer(), &task->alarm,
+                  (int32u_t) timeout, _os_rw_write_timeout, task);
+    _os_wait_in_queue(&rw->write_queue);
+    hal_restore_interrupt(flag);
+
+    /* 1: handed over by the releasing task with state == -1,
+     * 0: timed out, already uncounted by _os_rw_write_timeout() */
+    return (int32u_t) task->wait_result;
+}
+
+
+void eos_release_write(eos_rwlock_t *rw)
+{
+#if EOS_CFG_ARG_CHECKS
+    if (rw == NULL) {
+        PRINT("rwlock is NULL\n");
+        return;
+    }
+#endif
+
+    /* Waiters enqueue with interrupts disabled, so the check for
+     * waiters and the release must not be separated */
+    int32u_t flag = hal_disable_interrupt();
+    _os_rw_handoff(rw);
+    hal_restore_interrupt(flag);
+}
+#endif
+
+
+#if EOS_CFG_NOTIFY
+/*
+ * Task notifications
+ *     A waiting task sits alone in its own notify_queue, so the regular
+ *     wait queue and alarm logic provide blocking and timeouts.
+ */
+_OS_HOT int32u_t eos_notify(eos_tcb_t *task, int32u_t arg, int8u_t action)
+{
+#if EOS_CFG_ARG_CHECKS
+    if (task == NULL) {
+        PRINT("task is NULL\n");
+        return 0;
+    }
+#endif
+
+    int32u_t flag = hal_disable_interrupt();
+    switch (action) {
+    case NOTIFY_GIVE:
+        task->notify_value++;
+        break;
+    case NOTIFY_INCREMENT:
+        task->notify_value += arg;
+        break;
+    case NOTIFY_SET_BITS:
+        task->notify_value |= arg;
+        break;
+    case NOTIFY_NO_OVERWRITE:
+        if (task->notify_pending) {
+            hal_restore_interrupt(flag);
+            return 0;
+        }
+        task->notify_value = arg;
+        break;
+    default:
+        task->notify_value = arg;
+        break;
+    }
+    task->notify_pending = 1;
+
+    if (_os_has_waiters(&task->notify_queue)) {
+        _os_wakeup_from_queue(&task->notify_queue);
+    }
+    hal_restore_interrupt(flag);
+    return 1;
+}
+
+
+/* Blocks until the task is notified (count_mode: until its word is nonzero);
+ * called with interrupts disabled */
+_OS_HOT static int32u_t _os_wait_notify(eos_tcb_t *task, int32u_t count_mode, int32s_t timeout)
+{
+    while (count_mode ? task->notify_value == 0 : !task->notify_pending) {
+        if (timeout < 0 || eos_get_scheduler_lock()) {
+            return 0;
+        }
+        eos_set_alarm(eos_get_system_timer(), &task->alarm,
+                      (int32u_t) timeout, _os_wakeup_from_alarm_queue, task);
+        _os_wait_in_queue(&task->notify_queue);
+        if (!task->wait_result) {
+            /* Woken by the alarm */
+            return count_mode ? task->notify_value != 0 : task->notify_pending;
+        }
+    }
+    return 1;
+}
+
+
+_OS_HOT int32u_t eos_take_notification(int8u_t clear, int32s_t timeout)
+{
+    eos_tcb_t *task = eos_get_current_task();
+    int32u_t value = 0;
+
+    int32u_t flag = hal_disable_interrupt();
+    if (_os_wait_notify(task, 1, timeout)) {
+        value = task->notify_value;
+        task->notify_value = clear ? 0 : value - 1;
+        task->notify_pending = 0;
+    }
+    hal_restore_interrupt(flag);
+    return value;
+}
+
+
+_OS_HOT int32u_t eos_wait_notification(int32u_t clear_on_exit, int32u_t *value, int32s_t timeout)
+{
+    eos_tcb_t *task = eos_get_current_task();
+    int32u_t notified;
+
+    int32u_t flag = hal_disable_interrupt();
+    notified = _os_wait_notify(task, 0, timeout);
+    if (value) {
+        *value = task->notify_value;
+    }
+    if (notified) {
+        task->notify_value &= ~clear_on_exit;
+        task->notify_pending = 0;
+    }
+    hal_restore_interrupt(flag);
+    return notified;
+}
+#endif
 
 
 int8u_t eos_lock_scheduler() {
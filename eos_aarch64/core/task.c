@@ -10,12 +10,7 @@
 
 #include <core/eos.h>
 
-#define READY		    1
-#define RUNNING		    2
-#define WAITING		    3
-#define SUSPENDED       4
-
-#define MIN_STACK_SIZE 1024
+#define MIN_STACK_SIZE EOS_CFG_MIN_STACK_SIZE
 /**
  * Runqueue of ready tasks
  */
@@ -30,6 +25,200 @@ static _os_node_t *_os_ready_queue[LOWEST_PRIORITY + 1];
 static eos_tcb_t *_os_current_task;
 // 현재 실행 중인 태스크의 TCB를 가리키는 포인터 변수
 
+/**
+ * All created tasks, linked through tcb->next_task
+ */
+static eos_tcb_t *_os_task_list;
+
+/**
+ * CPU time accounting
+ *     _os_last_stamp: CNTPCT_EL0 when the running task or IRQ last started being charged
+ *     _os_in_irq: 1 while the elapsed time belongs to interrupt handling
+ */
+static int64u_t _os_boot_stamp;
+static int64u_t _os_last_stamp;
+static int8u_t _os_in_irq;
+
+/*
+ * Interrupt context
+ *     _os_irq_active: 1 while an interrupt handler runs
+ *     _os_irq_frame: saved context of the interrupted task
+ *     _os_resched_pending: eos_schedule() was called by the handler
+ */
+static int8u_t _os_irq_active;
+static addr_t _os_irq_frame;
+static int8u_t _os_resched_pending;
+
+
+/* Starts a new time slice; a task without slicing never reaches 0 */
+static void _os_refill_slice(eos_tcb_t *task)
+{
+    task->slice_left = task->time_slice ? task->time_slice : 1;
+}
+
+
+static void _os_reset_period_stats(eos_tcb_t *task)
+{
+    task->period_stats.jobs = 0;
+    task->period_stats.dropped_releases = 0;
+    task->period_stats.deadline_misses = 0;
+    task->period_stats.max_response = 0;
+    task->period_stats.min_start_delay = 0xFFFFFFFFu;
+    task->period_stats.max_start_delay = 0;
+}
+
+
+/* Aligns the task's current release to the latest offset + k * period
+ * not after now, or to the first release if it is still ahead */
+static void _os_align_release(eos_tcb_t *task)
+{
+    int32u_t now = eos_get_system_timer()->tick;
+
+    if (task->period == 0) {
+        task->wakeup_time = now;
+    } else if ((int32s_t)(now - task->offset) < 0) {
+        task->wakeup_time = task->offset;
+    } else {
+        task->wakeup_time = now - (now - task->offset) % task->period;
+    }
+}
+
+
+/* Charges the time since the last stamp to task as run or IRQ time */
+_OS_HOT static void _os_account_time(eos_tcb_t *task)
+{
+#if EOS_CFG_TASK_STATS
+    int64u_t now = read_cntpct_el0();
+
+    if (task) {
+        if (_os_in_irq) {
+            task->irq_cycles += now - _os_last_stamp;
+        } else {
+            task->run_cycles += now - _os_last_stamp;
+        }
+    }
+    _os_last_stamp = now;
+#else
+    (void)task;
+#endif
+#if EOS_CFG_PMU
+    _os_pmu_account(_os_in_irq ? NULL : task);
+#endif
+}
+
+
+
+#if EOS_CFG_WAIT_LEVEL_BLOCKS > 0
+static _os_wait_levels_t _os_wait_levels[EOS_CFG_WAIT_LEVEL_BLOCKS];
+#endif
+static _os_wait_levels_t *_os_free_wait_levels;
+
+
+void _os_init_wait_queue(_os_wait_queue_t *wait_queue, int8u_t queue_type)
+{
+    wait_queue->head = NULL;
+    wait_queue->levels = NULL;
+    wait_queue->queue_type = queue_type;
+}
+
+
+/* Appends a task to the FIFO, or behind the waiters of its priority */
+_OS_HOT static void _os_wait_queue_add(_os_wait_queue_t *wait_queue, eos_tcb_t *task)
+{
+    _os_wait_levels_t *levels = wait_queue->levels;
+    int32u_t level = task->priority;
+
+    task->queue_node.order_val = level;
+    if (!wait_queue->queue_type) {
+        _os_add_node_tail(&wait_queue->head, &task->queue_node);
+        return;
+    }
+
+    /* The first waiter takes a level block if one is left */
+    if (levels == NULL && wait_queue->head == NULL && _os_free_wait_levels) {
+        levels = _os_free_wait_levels;
+        _os_free_wait_levels = levels->next_free;
+        wait_queue->levels = levels;
+    }
+    if (levels == NULL) {
+        _os_add_node_ordered(&wait_queue->head, &task->queue_node);
+        return;
+    }
+
+    _os_add_node_tail(&levels->level[level], &task->queue_node);
+    levels->group |= _os_map_table[level >> 3];
+    levels->table[level >> 3] |= _os_map_table[level & 0x07];
+}
+
+
+_OS_HOT static void _os_wait_queue_remove(_os_wait_queue_t *wait_queue, eos_tcb_t *task)
+{
+    _os_wait_levels_t *levels = wait_queue->levels;
+    int32u_t level = task->queue_node.order_val;
+
+    if (levels == NULL) {
+        _os_remove_node(&wait_queue->head, &task->queue_node);
+        return;
+    }
+
+    _os_remove_node(&levels->level[level], &task->queue_node);
+    if (levels->level[level] == NULL &&
+        (levels->table[level >> 3] &= ~_os_map_table[level & 0x07]) == 0) {
+        levels->group &= ~_os_map_table[level >> 3];
+        if (levels->group == 0) {
+            /* The last waiter left: the block goes back to the pool */
+            wait_queue->levels = NULL;
+            levels->next_free = _os_free_wait_levels;
+            _os_free_wait_levels = levels;
+        }
+    }
+}
+
+
+/* First task of the queue, which must not be empty */
+_OS_HOT static eos_tcb_t *_os_wait_queue_first(_os_wait_queue_t *wait_queue)
+{
+    _os_wait_levels_t *levels = wait_queue->levels;
+
+    if (levels == NULL) {
+        return (eos_tcb_t *)wait_queue->head->pnode;
+    }
+
+    int8u_t y = _os_unmap_table[levels->group];
+    int32u_t level = (y << 3) + _os_unmap_table[levels->table[y]];
+
+    return (eos_tcb_t *)levels->level[level]->pnode;
+}
+
+
+static int32u_t _os_list_length(_os_node_t *head)
+{
+    _os_node_t *node = head;
+    int32u_t n = 0;
+
+    if (node) {
+        do {
+            n++;
+            node = node->next;
+        } while (node != head);
+    }
+    return n;
+}
+
+
+int32u_t _os_wait_queue_length(_os_wait_queue_t *wait_queue)
+{
+    _os_wait_levels_t *levels = wait_queue->levels;
+    int32u_t n = _os_list_length(wait_queue->head);
+
+    if (levels) {
+        for (int32u_t i = 0; i <= LOWEST_PRIORITY; i++) {
+            n += _os_list_length(levels->level[i]);
+        }
+    }
+    return n;
+}
+
 
 int32u_t eos_create_task(eos_tcb_t *task, addr_t sblock_start, size_t sblock_size, void (*entry)(void *arg), void *arg, int32u_t priority)
 {
@@ -57,10 +246,45 @@ int32u_t eos_create_task(eos_tcb_t *task, addr_t sblock_start, size_t sblock_siz
     /* Initializes period */
     task->period = 0;
     task->wakeup_time = 0;
+    task->deadline = 0;
+    task->offset = 0;
+    _os_reset_period_stats(task);
 
     /* Initializes list-related fields */
     task->queue_node.pnode = task;
     task->queue_node.order_val = task->priority;
+    task->wait_queue_owner = NULL;
+    task->wait_result = 0;
+
+#if EOS_CFG_NOTIFY
+    /* Initializes notifications */
+    task->notify_value = 0;
+    task->notify_pending = 0;
+    _os_init_wait_queue(&task->notify_queue, FIFO);
+#endif
+
+    /* Initializes round-robin time slice */
+    task->time_slice = DEFAULT_TIME_SLICE;
+    _os_refill_slice(task);
+
+#if EOS_CFG_TASK_STATS
+    /* Initializes statistics */
+    task->run_cycles = 0;
+    task->irq_cycles = 0;
+    task->voluntary_switches = 0;
+    task->involuntary_switches = 0;
+    task->releases = 0;
+#if EOS_CFG_PMU
+    for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+        task->pmu[i] = 0;
+    }
+#endif
+
+    /* Paints the stack for eos_get_stack_usage() */
+    task->stack_start = sblock_start;
+    task->stack_size = sblock_size;
+    _os_memset(sblock_start, STACK_FILL, sblock_size);
+#endif
 
     /* Creates a context and store the context in the tcb */
     task->sp = _os_create_context(sblock_start, sblock_size, entry, arg);
@@ -70,6 +294,8 @@ int32u_t eos_create_task(eos_tcb_t *task, addr_t sblock_start, size_t sblock_siz
 
     _os_add_node_tail(&_os_ready_queue[task->priority], &(task->queue_node));
     _os_set_ready(task->priority);
+    task->next_task = _os_task_list;
+    _os_task_list = task;
     _os_unlock_sync(flag, &_os_ready_queue_lock);
     task->status = READY;
 
@@ -85,7 +311,7 @@ int32u_t eos_destroy_task(eos_tcb_t *task)
 }
 
 
-void eos_schedule()
+_OS_HOT void eos_schedule()
 {
     /* Checks if the scheduler is locked */
     int32u_t flag = hal_disable_interrupt();
@@ -94,22 +320,48 @@ void eos_schedule()
         hal_restore_interrupt(flag);
         return;
     }
+    if (_os_irq_active) {
+        /* Switches once, when the interrupt handler is done */
+        _os_resched_pending = 1;
+        hal_restore_interrupt(flag);
+        return;
+    }
     hal_restore_interrupt(flag);
+    PMU_BEGIN(pmu_start);
+
+    eos_tcb_t *prev_task = _os_current_task;
+    int8u_t preempted = 0;
 
     if (_os_current_task) {
         if (_os_current_task->status == RUNNING) {
-            /* Inserts the running task into the ready queue */
-            _os_add_node_tail(&_os_ready_queue[_os_current_task->priority],
-                            &(_os_current_task->queue_node));
+            preempted = 1;
+            /* Inserts the running task into the ready queue:
+             * behind its peers once its slice is used up, otherwise in front
+             * of them so that it resumes first */
+            if (_os_current_task->slice_left == 0) {
+                _os_add_node_tail(&_os_ready_queue[_os_current_task->priority],
+                                &(_os_current_task->queue_node));
+                _os_refill_slice(_os_current_task);
+            } else {
+                _os_add_node_head(&_os_ready_queue[_os_current_task->priority],
+                                &(_os_current_task->queue_node));
+            }
             _os_set_ready(_os_current_task->priority);
             _os_current_task->status = READY;
+        } else {
+            /* The task blocks: it gets a full slice when it runs again */
+            _os_refill_slice(_os_current_task);
         }
-    PRINT("Saving context of current task %p with priority %u\n", (void*)_os_current_task, _os_current_task->priority);
+    TRACE("Saving context of current task %p with priority %u\n", (void*)_os_current_task, _os_current_task->priority);
 
-    /* Saves the current context */
-    addr_t sp = _os_save_context();
+    /* Saves the current context; an interrupted task already has one */
+    addr_t sp = _os_irq_frame;
+    _os_irq_frame = 0;
     if (!sp) {
-        return;  // Return to the preemption point after restoring context
+        sp = _os_save_context();
+        if (!sp) {
+            return;  // Return to the preemption point after restoring context
+        }
     }
 
     /* Saves the stack pointer in the tcb */
@@ -118,7 +370,7 @@ void eos_schedule()
         /* Reaches here when eOS call eos_schedule(): Only runs the next task */
     }
 
-    PRINT("Scheduling...\n");
+    TRACE("Scheduling...\n");
     /* Selects the next task to run */
     int32u_t highest_priority = _os_get_highest_priority();
     _os_node_t *node = _os_ready_queue[highest_priority];
@@ -129,17 +381,33 @@ void eos_schedule()
     if (!_os_ready_queue[next_task->priority])
         _os_unset_ready(next_task->priority);
 
+    /* Charges the elapsed time to the outgoing task */
+    _os_account_time(prev_task);
+    _os_in_irq = 0;     // The switch returns to the next task via eret
+#if EOS_CFG_TASK_STATS
+    if (prev_task && prev_task != next_task) {
+        if (preempted) {
+            prev_task->involuntary_switches++;
+        } else {
+            prev_task->voluntary_switches++;
+        }
+    }
+#else
+    (void)preempted;
+#endif
+
     /* Restores the context of the next task */
     next_task->status = RUNNING;
     _os_current_task = next_task;
-    PRINT("Switching to task %p with priority %u\n", (void*)next_task, next_task->priority);
+    TRACE("Switching to task %p with priority %u\n", (void*)next_task, next_task->priority);
+    PMU_END(eos_pmu_schedule, pmu_start);
     _os_restore_and_eret(next_task->sp);
 
     /* Never reaches here */
 }
 
 
-eos_tcb_t *eos_get_current_task()
+_OS_HOT eos_tcb_t *eos_get_current_task()
 {
 	return _os_current_task;
 }
@@ -163,7 +431,15 @@ void eos_change_priority(eos_tcb_t *task, int32u_t priority)
 
 	/* change the tcb */
 	task->priority = priority;
-	task->queue_node.order_val = task->priority;
+
+	/* A task blocked in a PRIORITY wait queue moves behind the waiters of its new priority */
+	int32u_t flag = hal_disable_interrupt();
+	_os_wait_queue_t *wait_queue = task->wait_queue_owner;
+	if (wait_queue && wait_queue->queue_type) {
+		_os_wait_queue_remove(wait_queue, task);
+		_os_wait_queue_add(wait_queue, task);
+	}
+	hal_restore_interrupt(flag);
 	
 	/* schedule with new priority set */
 	eos_schedule();
@@ -180,7 +456,8 @@ void eos_set_period(eos_tcb_t *task, int32u_t period)
 {
     // To be filled by students: Project 3
     task->period = period;
-    task->wakeup_time = eos_get_system_timer()->tick;
+    _os_align_release(task);
+    _os_reset_period_stats(task);
 }
 
 
@@ -190,6 +467,70 @@ int32u_t eos_get_period(eos_tcb_t *task)
 }
 
 
+void eos_set_release_offset(eos_tcb_t *task, int32u_t offset)
+{
+    task->offset = offset;
+    _os_align_release(task);
+}
+
+
+void eos_set_deadline(eos_tcb_t *task, int32u_t deadline)
+{
+    task->deadline = deadline;
+}
+
+
+void eos_get_period_stats(eos_tcb_t *task, eos_period_stats_t *stats)
+{
+    int32u_t flag = hal_disable_interrupt();
+    *stats = task->period_stats;
+    hal_restore_interrupt(flag);
+}
+
+
+void eos_set_time_slice(eos_tcb_t *task, int32u_t ticks)
+{
+    if (task == NULL) {
+        PRINT("task is NULL\n");
+        return;
+    }
+    task->time_slice = ticks;
+    _os_refill_slice(task);
+}
+
+
+int32u_t eos_get_time_slice(eos_tcb_t *task)
+{
+    return task->time_slice;
+}
+
+
+void eos_yield()
+{
+    _os_current_task->slice_left = 0;
+    eos_schedule();
+}
+
+
+_OS_HOT void _os_tick_time_slice(void)
+{
+    eos_tcb_t *task = _os_current_task;
+
+    if (task == NULL || task->status != RUNNING || task->time_slice == 0) {
+        return;
+    }
+
+    /* Alone at its priority: nothing to share, no accounting */
+    if (_os_ready_queue[task->priority] == NULL) {
+        return;
+    }
+
+    if (task->slice_left > 0) {
+        task->slice_left--;
+    }
+}
+
+
 int32u_t eos_suspend_task(eos_tcb_t *task)
 {
     if (task == NULL) {
@@ -223,6 +564,19 @@ int32u_t eos_resume_task(eos_tcb_t *task)
 }
 
 
+/* Blocks the current task on its alarm for timeout ticks */
+static void _os_sleep_ticks(int32u_t timeout)
+{
+    eos_set_alarm(eos_get_system_timer(), &_os_current_task->alarm, timeout, _os_wakeup_from_alarm_queue, _os_current_task);
+
+    /* Goes to the WAITING state */
+    _os_current_task->status = WAITING;
+
+    /* Selects a task from the ready list and runs it */
+    eos_schedule();
+}
+
+
 void eos_sleep(int32u_t tick)
 {
     // To be filled by students: Project 3
@@ -232,63 +586,123 @@ void eos_sleep(int32u_t tick)
         return;
     }
 
-    int32u_t timeout = tick;
-        
     if (tick == 0) { // tick을 0으로 지정한 경우, 0tick 동안 sleep하는 것이 아니라, 다음 주기까지 sleep하는 것으로 사용함.
-        if(_os_current_task->period != 0) {
+        if (_os_current_task->period != 0) {
             /* The current task is periodic */
-            _os_current_task->wakeup_time += _os_current_task->period;
-            if (_os_current_task->wakeup_time <= eos_get_system_timer()->tick) {
-                PRINT("There exist queued jobs, so execute them\n");
-                return;
-            }
-            timeout = _os_current_task->wakeup_time - eos_get_system_timer()->tick;
+            eos_wait_next_period();
+            return;
         }
     }
 
-    eos_set_alarm(eos_get_system_timer(), &_os_current_task->alarm, timeout, _os_wakeup_from_alarm_queue, _os_current_task);
+    _os_sleep_ticks(tick);
+}
 
-    /* Goes to the WAITING state */
-    _os_current_task->status = WAITING;
 
-    /* Selects a task from the ready list and runs it */
-    eos_schedule();
+int32u_t eos_wait_next_period()
+{
+    eos_tcb_t *task = _os_current_task;
+    eos_period_stats_t *stats = &task->period_stats;
+    int32u_t dropped = 0;
+
+    if (task->period == 0) {
+        PRINT("task %p is not periodic\n", (void*)task);
+        return 0;
+    }
+    if (eos_get_scheduler_lock() == LOCKED) {
+        PRINT("Can't sleep since scheduler is locked\n");
+        return 0;
+    }
+
+    int32u_t flag = hal_disable_interrupt();
+    int32u_t now = eos_get_system_timer()->tick;
+    int32u_t response = now - task->wakeup_time;
+    int32u_t deadline = task->deadline ? task->deadline : task->period;
+    int32u_t next = task->wakeup_time;
+
+    /* Completes the current job; before the first release there is none */
+    if ((int32s_t)response >= 0) {
+        next += task->period;
+        stats->jobs++;
+        if (response > stats->max_response) {
+            stats->max_response = response;
+        }
+        if (response > deadline) {
+            stats->deadline_misses++;
+        }
+    }
+
+    /* Releases already in the past are dropped */
+    if ((int32s_t)(now - next) > 0) {
+        dropped = (now - next) / task->period;
+        next += dropped * task->period;
+        stats->dropped_releases += dropped;
+    }
+    task->wakeup_time = next;
+
+    if ((int32s_t)(next - now) > 0) {
+        _os_sleep_ticks(next - now);
+    }
+
+    /* Starts the job: release-to-start delay gives the jitter */
+    int32u_t delay = eos_get_system_timer()->tick - task->wakeup_time;
+    if (delay < stats->min_start_delay) {
+        stats->min_start_delay = delay;
+    }
+    if (delay > stats->max_start_delay) {
+        stats->max_start_delay = delay;
+    }
+    hal_restore_interrupt(flag);
+
+    return dropped;
 }
 
 
-void _os_init_task() // 확인 완료 (25/09/07-이종원)
+_OS_COLD void _os_init_task() // 확인 완료 (25/09/07-이종원)
 {
     PRINT("Initializing task module\n");
 
     /* Initializes current_task */
     _os_current_task = NULL; 
+    _os_task_list = NULL;
+
+    /* Starts CPU time accounting */
+    _os_boot_stamp = read_cntpct_el0();
+    _os_last_stamp = _os_boot_stamp;
+    _os_in_irq = 0;
+    _os_irq_active = 0;
+    _os_irq_frame = 0;
+    _os_resched_pending = 0;
 
     /* Initializes multi-level ready_queue */
     for (int32u_t i = 0; i <= LOWEST_PRIORITY; i++) { //기존, i < LOWEST_PRIORITY로 되어있던 코드 수정 (25/09/07-이종원)
         _os_ready_queue[i] = NULL;
     }
+
+    /* Fills the pool of wait queue level blocks */
+    _os_free_wait_levels = NULL;
+#if EOS_CFG_WAIT_LEVEL_BLOCKS > 0
+    for (int32u_t i = 0; i < EOS_CFG_WAIT_LEVEL_BLOCKS; i++) {
+        _os_wait_levels[i].next_free = _os_free_wait_levels;
+        _os_free_wait_levels = &_os_wait_levels[i];
+    }
+#endif
 }
 
 
-void _os_wait_in_queue(_os_node_t **wait_queue, int8u_t queue_type)
+_OS_HOT void _os_wait_in_queue(_os_wait_queue_t *wait_queue)
 // 역할: 현재 실행 중인 태스크를 지정된 대기 큐에 삽입하고, 
 // 해당 태스크를 WAITING 상태로 변경한 후, 
 // 스케줄러를 호출하여 다른 태스크를 실행
-// wait_queue: 대기 큐의 헤드 노드를 가리키는 포인터 변수의 주소 -> *wait_queue는 헤드 노드의 주소, **wait_queue는 헤드 노드 자체
-// 어떤 wait_queue에 삽입될지가, 이때의 input으로 받는 값에 의해 결정 (ex) sem->wait_queue, cond->wait_queue 등)
-// queue_type: 대기 큐에서 테스크를 선택하는 기준을 지정 -> 0: FIFO, 1: 우선순위 기반
+// wait_queue: 태스크가 들어갈 대기 큐 (ex) &sem->wait_queue, &cond->wait_queue 등)
+// 큐에서 테스크를 선택하는 기준은 wait_queue->queue_type -> 0: FIFO, 1: 우선순위 기반
 
 {
     // To be filled by students: Project 4
-    if (!queue_type) { // FIFO 방식
-        _os_add_node_tail(wait_queue, &_os_current_task->queue_node);
-        // FIFO면 현재 태스크를 대기 큐의 맨 뒤에 삽입
-    } else {
-        _os_add_node_ordered(wait_queue, &_os_current_task->queue_node);
-        // PRIORITY면 현재 태스크를 우선순위에 따라 대기 큐에 삽입
-    }
+    /* FIFO면 맨 뒤에, PRIORITY면 같은 우선순위 태스크들의 뒤에 삽입 */
+    _os_wait_queue_add(wait_queue, _os_current_task);
 
     _os_current_task->wait_queue_owner = wait_queue;
+    _os_current_task->wait_result = 0;
     _os_current_task->status = WAITING;
 
     
@@ -297,44 +711,173 @@ void _os_wait_in_queue(_os_node_t **wait_queue, int8u_t queue_type)
 }
 
 
-void _os_wakeup_from_queue(_os_node_t **wait_queue)
+/* Moves the first task of a wait queue to the ready queue */
+_OS_HOT static void _os_release_from_queue(_os_wait_queue_t *wait_queue)
 {
-    // To be filled by students: Project 4
-    if(*wait_queue == NULL) return ;
-
     /* Get the first task */
-    eos_tcb_t *task = (eos_tcb_t*) (*wait_queue)->pnode;
+    eos_tcb_t *task = _os_wait_queue_first(wait_queue);
 
     /* Remove task from wait_queue */
-    _os_remove_node(wait_queue, &task->queue_node);
+    _os_wait_queue_remove(wait_queue, task);
+    task->wait_queue_owner = NULL;
+
+    /* The task is woken by another task: cancel its timeout alarm */
+    eos_set_alarm(eos_get_system_timer(), &task->alarm, 0, NULL, NULL);
+    task->wait_result = 1;
+#if EOS_CFG_TASK_STATS
+    task->releases++;
+#endif
 
     _os_add_node_tail(&_os_ready_queue[task->priority], &task->queue_node);
     _os_set_ready(task->priority);
     task->status = READY;
+}
+
+
+_OS_HOT void _os_wakeup_from_queue(_os_wait_queue_t *wait_queue)
+{
+    // To be filled by students: Project 4
+    if (!_os_has_waiters(wait_queue)) return ;
+
+    _os_release_from_queue(wait_queue);
 
     eos_schedule();
-  }
+}
 
 
-void _os_wakeup_all_from_queue(_os_node_t **wait_queue)
+_OS_HOT void _os_wakeup_all_from_queue(_os_wait_queue_t *wait_queue)
 {
-    // To be filled by students: not covered
+    if (!_os_has_waiters(wait_queue)) return;
+
+    while (_os_has_waiters(wait_queue)) {
+        _os_release_from_queue(wait_queue);
+    }
+
+    /* One scheduling decision for all woken tasks */
+    eos_schedule();
 }
 
 
-void _os_wakeup_from_alarm_queue(void *arg)
+_OS_HOT void _os_wakeup_from_alarm_queue(void *arg)
 {
     // To be filled by students: Project 3
     eos_tcb_t *task = (eos_tcb_t *) arg;
 
-    _os_node_t **wait_queue_owner = task->wait_queue_owner;
+    _os_wait_queue_t *wait_queue_owner = task->wait_queue_owner;
     if (wait_queue_owner != NULL) {
-        _os_remove_node(wait_queue_owner, &task->queue_node); // Remove current task from its wait queue that it was waiting on
+        _os_wait_queue_remove(wait_queue_owner, task); // Remove current task from its wait queue that it was waiting on
         task->wait_queue_owner = NULL; // Clear the task's wait_queue_owner after removing from wait queue
     }
 
     _os_add_node_tail(&_os_ready_queue[task->priority], &(task->queue_node));
     _os_set_ready(task->priority);
     task->status = READY;
+#if EOS_CFG_TASK_STATS
+    task->releases++;
+#endif
+}
+
+
+_OS_HOT void _os_irq_enter(addr_t frame)
+{
+    if (!_os_in_irq) {
+        _os_account_time(_os_current_task);
+        _os_in_irq = 1;
+    }
+    _os_irq_active = 1;
+    _os_irq_frame = frame;
+}
 
+
+_OS_HOT void _os_irq_exit(void)
+{
+    _os_irq_active = 0;
+    if (_os_resched_pending) {
+        _os_resched_pending = 0;
+        eos_schedule();     // may not return here if another task is selected
+    }
+    _os_irq_frame = 0;
+
+    if (_os_in_irq) {
+        _os_account_time(_os_current_task);
+        _os_in_irq = 0;
+    }
+}
+
+
+#if EOS_CFG_TASK_STATS
+int32u_t eos_get_task_stats(eos_task_stats_t *stats, int32u_t max_tasks)
+{
+    int32u_t n = 0;
+
+    if (stats == NULL) {
+        PRINT("stats is NULL\n");
+        return 0;
+    }
+
+    int32u_t flag = hal_disable_interrupt();
+
+    /* Brings the running task up to date */
+    _os_account_time(_os_current_task);
+
+    for (eos_tcb_t *task = _os_task_list; task && n < max_tasks; task = task->next_task) {
+        eos_task_stats_t *st = &stats[n++];
+        st->task = task;
+        st->priority = task->priority;
+        st->period = task->period;
+        st->status = task->status;
+        st->stack_size = task->stack_size;
+        st->run_cycles = task->run_cycles;
+        st->irq_cycles = task->irq_cycles;
+        st->voluntary_switches = task->voluntary_switches;
+        st->involuntary_switches = task->involuntary_switches;
+        st->releases = task->releases;
+#if EOS_CFG_PMU
+        for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+            st->pmu[i] = task->pmu[i];
+        }
+#endif
+    }
+    hal_restore_interrupt(flag);
+
+    return n;
+}
+
+
+size_t eos_get_stack_usage(eos_tcb_t *task)
+{
+    const int8u_t *p, *end;
+
+    if (task == NULL) {
+        PRINT("task is NULL\n");
+        return 0;
+    }
+
+    /* Stacks grow down: the first overwritten byte from the bottom marks
+     * the deepest point. Races with the task only make the result stale */
+    p = (const int8u_t *)task->stack_start;
+    end = p + task->stack_size;
+    while (p < end && *p == STACK_FILL) {
+        p++;
+    }
+    return (size_t)(end - p);
+}
+
+
+int32u_t eos_get_system_load(void)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    _os_account_time(_os_current_task);
+    int64u_t total = _os_last_stamp - _os_boot_stamp;
+    eos_tcb_t *idle = eos_get_idle_task();
+    int64u_t idle_cycles = idle ? idle->run_cycles : 0;
+
+    hal_restore_interrupt(flag);
+
+    if (total == 0) {
+        return 0;
+    }
+    return (int32u_t)(((total - idle_cycles) * 1000) / total);
 }
+#endif
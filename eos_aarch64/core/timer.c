@@ -25,13 +25,15 @@ int8u_t eos_init_counter(eos_counter_t *counter, int32u_t init_value)
 // 수정 완료 (25/09/07-이종원)
 
 
-void eos_set_alarm(eos_counter_t *counter, eos_alarm_t *alarm, int32u_t timeout, void (*entry)(void *arg), void *arg)
+_OS_HOT void eos_set_alarm(eos_counter_t *counter, eos_alarm_t *alarm, int32u_t timeout, void (*entry)(void *arg), void *arg)
 {
+#if EOS_CFG_ARG_CHECKS
     /* Validate inputs */
     if (counter == NULL || alarm == NULL) {
         PRINT("eos_set_alarm: invalid counter(%p) or alarm(%p)\n", (void*)counter, (void*)alarm);
         return;
     }
+#endif
 
     /* Removes the alarm from the counter if it exists in the counter */
     _os_remove_node(&(counter->alarm_queue), &(alarm->queue_node));
@@ -58,7 +60,39 @@ eos_counter_t *eos_get_system_timer()
 }
 
 
-void eos_trigger_counter(eos_counter_t *counter)
+int32u_t eos_get_alarms(eos_counter_t *counter, eos_alarm_t *alarms, int32u_t max_alarms)
+{
+    int32u_t n = 0;
+
+    if (counter == NULL || alarms == NULL) {
+        PRINT("invalid args counter=%p alarms=%p\n", (void*)counter, (void*)alarms);
+        return 0;
+    }
+
+    /* Interrupts stay off for at most max_alarms list steps */
+    int32u_t flag = hal_disable_interrupt();
+    _os_node_t *node = counter->alarm_queue;
+
+    while (node && n < max_alarms) {
+        eos_alarm_t *alarm = (eos_alarm_t *)node->pnode;
+        alarms[n].timeout = alarm->timeout;
+        alarms[n].handler = alarm->handler;
+        alarms[n].arg = alarm->arg;
+        alarms[n].queue_node.next = NULL;
+        alarms[n].queue_node.prev = NULL;
+        n++;
+        node = node->next;
+        if (node == counter->alarm_queue) {
+            break;
+        }
+    }
+    hal_restore_interrupt(flag);
+
+    return n;
+}
+
+
+_OS_HOT void eos_trigger_counter(eos_counter_t *counter)
 {
     if (counter == NULL) {
         PRINT("eos_trigger_counter: counter is NULL\n");
@@ -69,7 +103,10 @@ void eos_trigger_counter(eos_counter_t *counter)
 
     // Print the current time in ticks
     if (counter == &system_timer) {
-        PRINT("system clock: %d\n", counter->tick);
+        TRACE("system clock: %d\n", counter->tick);
+
+        /* Charges the tick to the running task's time slice */
+        _os_tick_time_slice();
     }
 
     if (counter->alarm_queue) { // eos_trigger_counter의 핵심 동작 2: 알람 큐에 등록된 알람들 중에서 만료된 것들을 처리
@@ -97,11 +134,14 @@ static void timer_interrupt_handler(int8s_t irqnum, void *arg)
 {
     /* Triggers alarms */
     _timer_rearm(); // Reload the timer
+#if EOS_CFG_PROFILE
+    _os_profile_tick();
+#endif
     eos_trigger_counter(&system_timer);
 }
 
 
-void _os_init_timer()
+_OS_COLD void _os_init_timer()
 {
     PRINT("Initializing timer module\n");
 
@@ -109,6 +149,6 @@ void _os_init_timer()
     // 시스템 전역 변수인 system_timer를 초기화 시킴
 
     /* Registers timer interrupt handler */
-    eos_set_interrupt_handler(IRQ_CNTP, timer_interrupt_handler, NULL);
-    // IRQ_CNTP: ARM 아키텍처에서 제공하는 기본 timer interrupt 번호
+    eos_set_interrupt_handler(IRQ_TICK, timer_interrupt_handler, NULL);
+    // IRQ_TICK: HAL이 정하는 tick interrupt 번호 (aarch64: CNTP PPI)
 }
@@ -0,0 +1,134 @@
+/********************************************************
+ * Filename: core/uart.c
+ *
+ * Description: Interrupt-driven serial input
+ *     The receive interrupt drains the UART FIFO into a ring; the HAL
+ *     raises it on a FIFO level or after the line goes idle, so one
+ *     interrupt covers a burst of characters. Readers block on a
+ *     semaphore that the handler releases once per burst.
+ ********************************************************/
+
+#include <core/eos.h>
+
+#if EOS_CFG_UART_RX
+
+#if IRQ_UART0 >= IRQ_MAX
+#error "IRQ_UART0 has no ICB: raise EOS_CFG_IRQ_MAX"
+#endif
+
+#define RX_RING_SIZE EOS_CFG_UART_RX_SIZE
+#define RX_RING_MASK (RX_RING_SIZE - 1)
+
+static int8u_t _os_rx_ring[RX_RING_SIZE];
+static volatile int32u_t _os_rx_head;   // free-running, written by the handler
+static volatile int32u_t _os_rx_tail;   // free-running, written by readers
+static eos_semaphore_t _os_rx_ready;    // count stays 0 or 1: "data may be there"
+static eos_uart_stats_t _os_uart_stats;
+
+
+static void _os_uart_rx_handler(int8s_t irqnum, void *arg)
+{
+    int32u_t err, stored = 0;
+    int32s_t c;
+
+    _os_uart_stats.rx_irqs++;
+
+    while ((c = hal_uart_getc(&err)) >= 0) {
+        if (err) {
+            if (err & UART_RX_OVERRUN) _os_uart_stats.fifo_overruns++;
+            if (err & UART_RX_FRAMING) _os_uart_stats.framing_errors++;
+            if (err & UART_RX_PARITY) _os_uart_stats.parity_errors++;
+            if (err & UART_RX_BREAK) _os_uart_stats.breaks++;
+            if (err & (UART_RX_FRAMING | UART_RX_PARITY | UART_RX_BREAK)) {
+                continue;       // the character itself is bad
+            }
+        }
+        if (_os_rx_head - _os_rx_tail == RX_RING_SIZE) {
+            _os_uart_stats.ring_overruns++;
+            continue;
+        }
+        _os_rx_ring[_os_rx_head & RX_RING_MASK] = (int8u_t)c;
+        _os_rx_head++;
+        stored++;
+    }
+    hal_uart_rx_ack();
+
+    _os_uart_stats.rx_bytes += stored;
+
+    /* One wakeup per burst; a pending one is not stacked up */
+    if (stored > 0 && _os_rx_ready.count <= 0) {
+        eos_release_semaphore(&_os_rx_ready);
+    }
+}
+
+
+/* Moves up to size buffered bytes into buf */
+static int32u_t _os_uart_take(int8u_t *buf, int32u_t size)
+{
+    int32u_t flag = hal_disable_interrupt();
+    int32u_t tail = _os_rx_tail;
+    int32u_t n = _os_rx_head - tail;
+    int32u_t first;
+
+    if (n > size) {
+        n = size;
+    }
+
+    /* At most two pieces: up to the end of the ring, then from its start */
+    first = RX_RING_SIZE - (tail & RX_RING_MASK);
+    if (first > n) {
+        first = n;
+    }
+    _os_memcpy(buf, &_os_rx_ring[tail & RX_RING_MASK], first);
+    _os_memcpy(buf + first, _os_rx_ring, n - first);
+    _os_rx_tail = tail + n;
+
+    hal_restore_interrupt(flag);
+    return n;
+}
+
+
+int32u_t eos_uart_read(void *buf, int32u_t size, int32s_t timeout)
+{
+    int32u_t n;
+
+#if EOS_CFG_ARG_CHECKS
+    if (buf == NULL || size == 0) {
+        PRINT("invalid args buf=%p size=%u\n", buf, size);
+        return 0;
+    }
+#endif
+
+    /* A wakeup can find the ring already emptied by another reader:
+     * then it waits again */
+    while ((n = _os_uart_take((int8u_t *)buf, size)) == 0) {
+        if (eos_acquire_semaphore(&_os_rx_ready, timeout) == 0) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+
+void eos_get_uart_stats(eos_uart_stats_t *stats)
+{
+    int32u_t flag = hal_disable_interrupt();
+
+    *stats = _os_uart_stats;
+    hal_restore_interrupt(flag);
+}
+
+
+_OS_COLD void _os_init_uart()
+{
+    PRINT("Initializing serial input\n");
+
+    _os_rx_head = 0;
+    _os_rx_tail = 0;
+    eos_init_semaphore(&_os_rx_ready, 0, FIFO);
+
+    eos_set_interrupt_handler(IRQ_UART0, _os_uart_rx_handler, NULL);
+    hal_uart_rx_init();
+}
+
+#endif
@@ -0,0 +1,338 @@
+#include <core/eos.h>
+#include "mmio.h"
+#include "blk.h"
+
+/*
+ * virtio-blk over virtio-mmio (legacy version 1 and version 2 transports)
+ *     One split virtqueue. Request slot k owns descriptors 3k..3k+2:
+ *     header (device reads), data (device reads or writes), status byte
+ *     (device writes). Slots are chained once at init, so queuing a
+ *     request only fills in addresses and publishes the head in the
+ *     available ring; hal_blk_kick() then notifies the device once for
+ *     everything published since the last kick.
+ *
+ *     The MMU is off: the rings are plain memory the device reads with
+ *     DMA, no cache maintenance is needed, and all accesses are aligned.
+ */
+
+#if EOS_CFG_BLK
+
+/* QEMU virt: 32 transports of 0x200 bytes, SPI 16 + n */
+#define VIRTIO_MMIO_BASE        0x0a000000UL
+#define VIRTIO_MMIO_STRIDE      0x200
+#define VIRTIO_MMIO_COUNT       32
+#define VIRTIO_MMIO_IRQ0        48
+
+/* Transport registers */
+#define VIRTIO_MAGIC            0x000   // "virt"
+#define VIRTIO_VERSION          0x004   // 1: legacy, 2: virtio 1.x
+#define VIRTIO_DEVICE_ID        0x008
+#define VIRTIO_DEVICE_FEATURES  0x010
+#define VIRTIO_DEVICE_FEAT_SEL  0x014
+#define VIRTIO_DRIVER_FEATURES  0x020
+#define VIRTIO_DRIVER_FEAT_SEL  0x024
+#define VIRTIO_GUEST_PAGE_SIZE  0x028   // legacy
+#define VIRTIO_QUEUE_SEL        0x030
+#define VIRTIO_QUEUE_NUM_MAX    0x034
+#define VIRTIO_QUEUE_NUM        0x038
+#define VIRTIO_QUEUE_ALIGN      0x03c   // legacy
+#define VIRTIO_QUEUE_PFN        0x040   // legacy
+#define VIRTIO_QUEUE_READY      0x044
+#define VIRTIO_QUEUE_NOTIFY     0x050
+#define VIRTIO_INT_STATUS       0x060
+#define VIRTIO_INT_ACK          0x064
+#define VIRTIO_STATUS           0x070
+#define VIRTIO_QUEUE_DESC_LOW   0x080
+#define VIRTIO_QUEUE_DESC_HIGH  0x084
+#define VIRTIO_QUEUE_AVAIL_LOW  0x090
+#define VIRTIO_QUEUE_AVAIL_HIGH 0x094
+#define VIRTIO_QUEUE_USED_LOW   0x0a0
+#define VIRTIO_QUEUE_USED_HIGH  0x0a4
+#define VIRTIO_CONFIG_GEN       0x0fc
+#define VIRTIO_CONFIG           0x100   // virtio-blk: capacity (u64) first
+
+#define VIRTIO_MAGIC_VALUE      0x74726976u
+#define VIRTIO_ID_BLOCK         2
+
+#define STATUS_ACKNOWLEDGE      1u
+#define STATUS_DRIVER           2u
+#define STATUS_DRIVER_OK        4u
+#define STATUS_FEATURES_OK      8u
+
+#define BLK_F_FLUSH             (1u << 9)
+#define F_VERSION_1             (1u << 0)   // bit 32: second feature word
+
+#define VRING_DESC_F_NEXT       1u
+#define VRING_DESC_F_WRITE      2u
+#define VRING_USED_F_NO_NOTIFY  1u
+
+#define PAGE_SIZE               4096u
+
+/* Three descriptors per request, rounded up to a power of two */
+#define BLK_SLOTS               EOS_CFG_BLK_QUEUE_DEPTH
+#define VQ_SIZE                 (BLK_SLOTS * 4)
+
+typedef struct vring_desc {
+    int64u_t addr;
+    int32u_t len;
+    int16u_t flags;
+    int16u_t next;
+} vring_desc_t;
+
+typedef struct vring_avail {
+    int16u_t flags;
+    int16u_t idx;
+    int16u_t ring[VQ_SIZE];
+    int16u_t used_event;
+} vring_avail_t;
+
+typedef struct vring_used_elem {
+    int32u_t id;
+    int32u_t len;
+} vring_used_elem_t;
+
+typedef struct vring_used {
+    int16u_t flags;
+    int16u_t idx;
+    vring_used_elem_t ring[VQ_SIZE];
+    int16u_t avail_event;
+} vring_used_t;
+
+typedef struct virtio_blk_req {
+    int32u_t type;
+    int32u_t reserved;
+    int64u_t sector;
+} virtio_blk_req_t;
+
+/* Legacy layout: descriptors and available ring, then the used ring
+ * on the next page; version 2 uses the same memory */
+#define VQ_USED_OFFSET  ((sizeof(vring_desc_t) * VQ_SIZE + sizeof(vring_avail_t) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
+#define VQ_MEM_SIZE     ((VQ_USED_OFFSET + sizeof(vring_used_t) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
+
+static int8u_t _vq_mem[VQ_MEM_SIZE] __attribute__((aligned(PAGE_SIZE)));
+static vring_desc_t *_vq_desc;
+static vring_avail_t *_vq_avail;
+static volatile vring_used_t *_vq_used;
+static int16u_t _vq_last_used;          // next used entry to reap
+
+static virtio_blk_req_t _blk_hdr[BLK_SLOTS];
+static volatile int8u_t _blk_status[BLK_SLOTS];
+static void *_blk_tag[BLK_SLOTS];
+static int16u_t _blk_free[BLK_SLOTS];   // stack of free slots
+static int32u_t _blk_nfree;
+
+static addr_t _blk_base;
+static int64u_t _blk_sectors;
+
+
+static inline void _blk_write(int32u_t reg, int32u_t v)
+{
+    mmio_write32(_blk_base + reg, v);
+}
+
+static inline int32u_t _blk_read(int32u_t reg)
+{
+    return mmio_read32(_blk_base + reg);
+}
+
+/* Ring updates reach memory before the device is told about them */
+static inline void _blk_barrier(void)
+{
+    __asm__ volatile("dmb sy" ::: "memory");
+}
+
+
+static void _blk_init_vq(void)
+{
+    _os_memset(_vq_mem, 0, sizeof(_vq_mem));
+    _vq_desc = (vring_desc_t *)_vq_mem;
+    _vq_avail = (vring_avail_t *)(_vq_mem + sizeof(vring_desc_t) * VQ_SIZE);
+    _vq_used = (volatile vring_used_t *)(_vq_mem + VQ_USED_OFFSET);
+    _vq_last_used = 0;
+
+    /* Fixed chains: header -> data -> status */
+    for (int32u_t k = 0; k < BLK_SLOTS; k++) {
+        vring_desc_t *d = &_vq_desc[3 * k];
+
+        d[0].addr = (int64u_t)&_blk_hdr[k];
+        d[0].len = sizeof(virtio_blk_req_t);
+        d[0].flags = VRING_DESC_F_NEXT;
+        d[0].next = (int16u_t)(3 * k + 1);
+        d[1].flags = VRING_DESC_F_NEXT;
+        d[1].next = (int16u_t)(3 * k + 2);
+        d[2].addr = (int64u_t)&_blk_status[k];
+        d[2].len = 1;
+        d[2].flags = VRING_DESC_F_WRITE;
+
+        _blk_free[k] = (int16u_t)k;
+    }
+    _blk_nfree = BLK_SLOTS;
+}
+
+
+/* Feature negotiation and queue setup; returns 0 on success */
+static int32s_t _blk_setup(int32u_t version)
+{
+    int32u_t status = STATUS_ACKNOWLEDGE | STATUS_DRIVER;
+    int32u_t features;
+
+    _blk_write(VIRTIO_STATUS, 0);       // reset
+    _blk_write(VIRTIO_STATUS, STATUS_ACKNOWLEDGE);
+    _blk_write(VIRTIO_STATUS, status);
+
+    _blk_write(VIRTIO_DEVICE_FEAT_SEL, 0);
+    features = _blk_read(VIRTIO_DEVICE_FEATURES) & BLK_F_FLUSH;
+    _blk_write(VIRTIO_DRIVER_FEAT_SEL, 0);
+    _blk_write(VIRTIO_DRIVER_FEATURES, features);
+
+    if (version >= 2) {
+        _blk_write(VIRTIO_DEVICE_FEAT_SEL, 1);
+        if (!(_blk_read(VIRTIO_DEVICE_FEATURES) & F_VERSION_1)) {
+            PRINT("virtio-blk: no VERSION_1 on a version %u transport\n", version);
+            return -1;
+        }
+        _blk_write(VIRTIO_DRIVER_FEAT_SEL, 1);
+        _blk_write(VIRTIO_DRIVER_FEATURES, F_VERSION_1);
+
+        status |= STATUS_FEATURES_OK;
+        _blk_write(VIRTIO_STATUS, status);
+        if (!(_blk_read(VIRTIO_STATUS) & STATUS_FEATURES_OK)) {
+            PRINT("virtio-blk: features refused\n");
+            return -1;
+        }
+    } else {
+        _blk_write(VIRTIO_GUEST_PAGE_SIZE, PAGE_SIZE);
+    }
+
+    _blk_write(VIRTIO_QUEUE_SEL, 0);
+    if (_blk_read(VIRTIO_QUEUE_NUM_MAX) < VQ_SIZE) {
+        PRINT("virtio-blk: queue holds %u descriptors, %u needed: lower EOS_CFG_BLK_QUEUE_DEPTH\n",
+              _blk_read(VIRTIO_QUEUE_NUM_MAX), VQ_SIZE);
+        return -1;
+    }
+    _blk_init_vq();
+    _blk_write(VIRTIO_QUEUE_NUM, VQ_SIZE);
+
+    if (version >= 2) {
+        int64u_t desc = (int64u_t)_vq_desc, avail = (int64u_t)_vq_avail, used = (int64u_t)_vq_used;
+
+        _blk_write(VIRTIO_QUEUE_DESC_LOW, (int32u_t)desc);
+        _blk_write(VIRTIO_QUEUE_DESC_HIGH, (int32u_t)(desc >> 32));
+        _blk_write(VIRTIO_QUEUE_AVAIL_LOW, (int32u_t)avail);
+        _blk_write(VIRTIO_QUEUE_AVAIL_HIGH, (int32u_t)(avail >> 32));
+        _blk_write(VIRTIO_QUEUE_USED_LOW, (int32u_t)used);
+        _blk_write(VIRTIO_QUEUE_USED_HIGH, (int32u_t)(used >> 32));
+        _blk_write(VIRTIO_QUEUE_READY, 1);
+    } else {
+        _blk_write(VIRTIO_QUEUE_ALIGN, PAGE_SIZE);
+        _blk_write(VIRTIO_QUEUE_PFN, (int32u_t)((int64u_t)_vq_mem / PAGE_SIZE));
+    }
+
+    _blk_write(VIRTIO_STATUS, status | STATUS_DRIVER_OK);
+    return 0;
+}
+
+
+static int64u_t _blk_read_capacity(int32u_t version)
+{
+    int32u_t gen, lo, hi;
+
+    /* Two 32-bit reads: retried if the device changed the config between them */
+    do {
+        gen = (version >= 2) ? _blk_read(VIRTIO_CONFIG_GEN) : 0;
+        lo = _blk_read(VIRTIO_CONFIG);
+        hi = _blk_read(VIRTIO_CONFIG + 4);
+    } while (version >= 2 && gen != _blk_read(VIRTIO_CONFIG_GEN));
+
+    return ((int64u_t)hi << 32) | lo;
+}
+
+
+_OS_COLD int32s_t hal_blk_init(void)
+{
+    for (int32u_t n = 0; n < VIRTIO_MMIO_COUNT; n++) {
+        addr_t base = (addr_t)(VIRTIO_MMIO_BASE + n * VIRTIO_MMIO_STRIDE);
+        int32u_t version;
+
+        if (mmio_read32(base + VIRTIO_MAGIC) != VIRTIO_MAGIC_VALUE ||
+            mmio_read32(base + VIRTIO_DEVICE_ID) != VIRTIO_ID_BLOCK) {
+            continue;       // empty transports read device id 0
+        }
+
+        _blk_base = base;
+        version = _blk_read(VIRTIO_VERSION);
+        if (_blk_setup(version) != 0) {
+            _blk_write(VIRTIO_STATUS, 0);
+            return -1;
+        }
+        _blk_sectors = _blk_read_capacity(version);
+
+        PRINT("virtio-blk at %p (version %u), %u descriptors\n", (void*)base, version, VQ_SIZE);
+        return (int32s_t)(VIRTIO_MMIO_IRQ0 + n);
+    }
+    return -1;
+}
+
+
+int64u_t hal_blk_capacity(void)
+{
+    return _blk_sectors;
+}
+
+
+_OS_HOT void hal_blk_enqueue(int8u_t op, int64u_t sector, void *buf, int32u_t len, void *tag)
+{
+    int32u_t k = _blk_free[--_blk_nfree];
+    vring_desc_t *d = &_vq_desc[3 * k];
+
+    _blk_hdr[k].type = op;
+    _blk_hdr[k].reserved = 0;
+    _blk_hdr[k].sector = sector;
+    _blk_status[k] = BLK_PENDING;
+    _blk_tag[k] = tag;
+
+    if (len == 0) {
+        d[0].flags = VRING_DESC_F_NEXT;     // flush: header -> status
+        d[0].next = (int16u_t)(3 * k + 2);
+    } else {
+        d[0].flags = VRING_DESC_F_NEXT;
+        d[0].next = (int16u_t)(3 * k + 1);
+        d[1].addr = (int64u_t)buf;
+        d[1].len = len;
+        d[1].flags = VRING_DESC_F_NEXT | (op == BLK_READ ? VRING_DESC_F_WRITE : 0);
+    }
+
+    /* The entry is filled before the index that hands it over */
+    _vq_avail->ring[_vq_avail->idx % VQ_SIZE] = (int16u_t)(3 * k);
+    _blk_barrier();
+    _vq_avail->idx++;
+}
+
+
+_OS_HOT void hal_blk_kick(void)
+{
+    _blk_barrier();
+    if (!(_vq_used->flags & VRING_USED_F_NO_NOTIFY)) {
+        _blk_write(VIRTIO_QUEUE_NOTIFY, 0);
+    }
+}
+
+
+_OS_HOT void hal_blk_reap(void)
+{
+    /* Acknowledged first: a completion after this raises the line again */
+    _blk_write(VIRTIO_INT_ACK, _blk_read(VIRTIO_INT_STATUS));
+
+    while (_vq_last_used != _vq_used->idx) {
+        int32u_t k;
+
+        _blk_barrier();
+        k = _vq_used->ring[_vq_last_used % VQ_SIZE].id / 3;
+        _vq_last_used++;
+
+        _blk_free[_blk_nfree++] = (int16u_t)k;
+        _os_blk_complete(_blk_tag[k], _blk_status[k]);
+    }
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef BLK_H_
+#define BLK_H_
+#include "type.h"
+
+/*
+ * virtio-blk 디스크 (QEMU virt의 virtio-mmio 트랜스포트)
+ *   run.sh에 DISK=<이미지>를 주면 붙는다
+ */
+
+/* virtio-blk 장치를 찾아 초기화: 장치의 IRQ 번호, 없으면 -1 */
+int32s_t hal_blk_init(void);
+
+/* 디스크 크기 (512바이트 섹터 수) */
+int64u_t hal_blk_capacity(void);
+
+/* 요청 하나를 virtqueue에 넣는다 (장치 통지는 하지 않음)
+ *   인터럽트를 끈 상태에서 호출, 빈 슬롯은 호출자가 보장 */
+void hal_blk_enqueue(int8u_t op, int64u_t sector, void *buf, int32u_t len, void *tag);
+
+/* 지금까지 넣은 요청을 장치에 한 번에 통지 */
+void hal_blk_kick(void);
+
+/* 인터럽트 처리: 끝난 요청마다 _os_blk_complete(tag, status) */
+void hal_blk_reap(void);
+
+#endif  // BLK_H_
@@ -1,3 +1,4 @@
+#include <core/eos.h>
 #include "type.h"
 #include "uart.h"
 #include "context.h"
@@ -13,12 +14,6 @@
         4. _os_restore_context 
 */
 
-static inline void *memset(void *dst, int val, size_t n) {
-    int8u_t *p = dst;
-    while (n--) *p++ = (int8u_t)val;
-    return dst;
-}
-
 void print_context(addr_t ctx_addr)
 {
     _os_context_t *ctx = (_os_context_t *)ctx_addr;
@@ -51,7 +46,7 @@ addr_t _os_create_context(addr_t stack_base, size_t stack_size, void (*entry)(vo
     _os_context_t *ctx = (_os_context_t *)(sp - sizeof(_os_context_t));
 
     // 3) 전체 0 초기화로 안전성 확보
-    memset(ctx, 0, sizeof(*ctx));
+    _os_memset(ctx, 0, sizeof(*ctx));
 
      // 트램펄린 없이 첫 진입: x0=arg, ELR=entry
     ctx->x[0]     = (int64u_t)arg;      // entry의 첫 인자
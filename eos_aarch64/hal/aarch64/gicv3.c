@@ -0,0 +1,162 @@
+#include "type.h"
+#include "mmio.h"
+#include "interrupt.h"
+#include <core/eos_config.h>
+
+/*
+ * GICv3: distributor with affinity routing, one redistributor per CPU
+ * for SGIs and PPIs, and the CPU interface in system registers
+ * (EOS_CFG_GIC_VERSION 3). Acknowledge and EOI are an MRS and an MSR
+ * instead of GICC_IAR/GICC_EOIR loads and stores; under virtualization
+ * they do not trap to the hypervisor's MMIO emulation.
+ *
+ * All interrupts are Group 1 (IRQ), routed to CPU0. EL2 must have set
+ * ICC_SRE_EL2.{SRE,Enable} (entry.S) so that EL1 can use ICC_SRE_EL1.
+ */
+
+#if EOS_CFG_GIC_VERSION == 3
+
+/* Distributor registers beyond the GICv2 set in interrupt.h */
+#define GICD_TYPER          (GICD_BASE + 0x0004)
+#define GICD_IROUTER        (GICD_BASE + 0x6000)    // 64-bit per SPI, from INTID 32
+#define GICD_CTLR_RWP       (1u << 31)
+#define GICD_CTLR_ENABLE    0x13u   // Grp1 (both views), ARE
+
+/* Redistributor: RD_base frame, then SGI_base frame 64 KiB above */
+#define GICR_STRIDE         0x20000
+#define GICR_CTLR           0x0000
+#define GICR_TYPER          0x0008  // [63:32] affinity, bit 4: last redistributor
+#define GICR_WAKER          0x0014
+#define GICR_SGI_BASE       0x10000
+#define GICR_IGROUPR0       (GICR_SGI_BASE + 0x0080)
+#define GICR_ISENABLER0     (GICR_SGI_BASE + 0x0100)
+#define GICR_ICENABLER0     (GICR_SGI_BASE + 0x0180)
+#define GICR_IPRIORITYR     (GICR_SGI_BASE + 0x0400)
+#define GICR_CTLR_RWP       (1u << 3)
+#define GICR_TYPER_LAST     (1u << 4)
+#define GICR_WAKER_SLEEP    (1u << 1)   // ProcessorSleep
+#define GICR_WAKER_ASLEEP   (1u << 2)   // ChildrenAsleep
+
+#define GIC_PRIORITY        0xA0        // every line, below the 0xFF mask
+#define GIC_SPURIOUS        1020
+
+/* -------------------- Internal state -------------------- */
+static addr_t _gicr;                    // redistributor of CPU0
+
+static inline void _gicd_wait_rwp(void)
+{
+    while (mmio_read32(GICD_CTLR) & GICD_CTLR_RWP) { }
+}
+
+static inline void _gicr_wait_rwp(void)
+{
+    while (mmio_read32(_gicr + GICR_CTLR) & GICR_CTLR_RWP) { }
+}
+
+/* Finds the redistributor whose affinity matches this CPU */
+static addr_t _gicr_find(void)
+{
+    int64u_t mpidr;
+    int32u_t aff;
+
+    __asm__ volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
+    aff = (int32u_t)(((mpidr >> 8) & 0xFF000000u) | (mpidr & 0x00FFFFFFu));
+
+    for (addr_t rd = GICR_BASE; ; rd += GICR_STRIDE) {
+        int32u_t typer_lo = mmio_read32(rd + GICR_TYPER);
+
+        if (mmio_read32(rd + GICR_TYPER + 4) == aff) {
+            return rd;
+        }
+        if (typer_lo & GICR_TYPER_LAST) {
+            return GICR_BASE;   // not found: QEMU numbers CPU0 first
+        }
+    }
+}
+
+/* -------------------- Initialization -------------------- */
+_OS_COLD void _gic_init(void)
+{
+    int32u_t lines = ((mmio_read32(GICD_TYPER) & 0x1F) + 1) * 32;
+    int64u_t sre;
+
+    // 1. Distributor: off, SPIs to Group 1 at one priority, routed to CPU0
+    mmio_write32(GICD_CTLR, 0);
+    _gicd_wait_rwp();
+    for (int32u_t n = 32; n < lines; n += 32) {
+        mmio_write32(GICD_ICENABLER0 + n / 8, 0xFFFFFFFFu);
+        mmio_write32(GICD_IGROUPR0 + n / 8, 0xFFFFFFFFu);
+    }
+    for (int32u_t n = 32; n < lines; n += 4) {
+        mmio_write32(GICD_IPRIORITYR + n, GIC_PRIORITY * 0x01010101u);
+    }
+    for (int32u_t n = 32; n < lines; n++) {
+        mmio_write32(GICD_IROUTER + n * 8, 0);       // Aff0..2 = 0
+        mmio_write32(GICD_IROUTER + n * 8 + 4, 0);   // Aff3 = 0
+    }
+    mmio_write32(GICD_CTLR, GICD_CTLR_ENABLE);
+    _gicd_wait_rwp();
+
+    // 2. Redistributor: wake it, SGIs and PPIs to Group 1
+    _gicr = _gicr_find();
+    mmio_write32(_gicr + GICR_WAKER, mmio_read32(_gicr + GICR_WAKER) & ~GICR_WAKER_SLEEP);
+    while (mmio_read32(_gicr + GICR_WAKER) & GICR_WAKER_ASLEEP) { }
+    mmio_write32(_gicr + GICR_ICENABLER0, 0xFFFFFFFFu);
+    _gicr_wait_rwp();
+    mmio_write32(_gicr + GICR_IGROUPR0, 0xFFFFFFFFu);
+    for (int32u_t n = 0; n < 32; n += 4) {
+        mmio_write32(_gicr + GICR_IPRIORITYR + n, GIC_PRIORITY * 0x01010101u);
+    }
+
+    // 3. CPU interface in system registers: accept all priorities,
+    //    no preemption split, EOI also deactivates (EOImode 0)
+    __asm__ volatile("mrs %0, icc_sre_el1" : "=r"(sre));
+    __asm__ volatile("msr icc_sre_el1, %0" :: "r"(sre | 1));
+    __asm__ volatile("isb");
+    __asm__ volatile("msr icc_pmr_el1, %0" :: "r"((int64u_t)0xFF));
+    __asm__ volatile("msr icc_bpr1_el1, %0" :: "r"((int64u_t)0));
+    __asm__ volatile("msr icc_ctlr_el1, %0" :: "r"((int64u_t)0));
+    __asm__ volatile("msr icc_igrpen1_el1, %0" :: "r"((int64u_t)1));
+    __asm__ volatile("isb");
+}
+
+/* -------------------- IRQ line control -------------------- */
+void hal_enable_irq_line(int32s_t irq)
+{
+    if (irq < 32) {
+        mmio_write32(_gicr + GICR_ISENABLER0, 1u << irq);
+    } else {
+        mmio_write32(GICD_ISENABLER0 + (irq / 32) * 4, 1u << (irq % 32));
+    }
+}
+
+/* Returns once the line can no longer be signalled */
+void hal_disable_irq_line(int32s_t irq)
+{
+    if (irq < 32) {
+        mmio_write32(_gicr + GICR_ICENABLER0, 1u << irq);
+        _gicr_wait_rwp();
+    } else {
+        mmio_write32(GICD_ICENABLER0 + (irq / 32) * 4, 1u << (irq % 32));
+        _gicd_wait_rwp();
+    }
+}
+
+/* -------------------- IRQ acknowledge & EOI -------------------- */
+_OS_HOT int32s_t hal_get_irq(void)
+{
+    int64u_t iar;
+
+    __asm__ volatile("mrs %0, icc_iar1_el1" : "=r"(iar) :: "memory");
+    if ((iar & 0xFFFFFF) >= GIC_SPURIOUS)  // 1020..1023: special / spurious
+        return -1;
+    return (int32s_t)(iar & 0xFFFFFF);
+}
+
+/* Priority drop and deactivation in one write (EOImode 0) */
+_OS_HOT void hal_ack_irq(int32u_t irq)
+{
+    __asm__ volatile("msr icc_eoir1_el1, %0" :: "r"((int64u_t)irq) : "memory");
+}
+
+#endif
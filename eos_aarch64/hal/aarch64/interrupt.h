@@ -56,7 +56,7 @@ void hal_enable_interrupt(void);
 int64u_t hal_disable_interrupt(void);
 void hal_restore_interrupt(int64u_t flag);
 
-int32u_t hal_get_irq(void);
+int32s_t hal_get_irq(void);
 void hal_ack_irq(int32u_t irq);
 void _deliver_irq(void);
 
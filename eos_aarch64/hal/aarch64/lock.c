@@ -1,25 +1,36 @@
 #include <core/eos.h>
 
-void _os_spin_lock(_os_spinlock_t *lock)
+/*
+ * Spinlocks
+ *     TAS:    test-and-set on one word (every waiter hammers the same line)
+ *     Ticket: FIFO order, waiters watch the owner half-word
+ *     MCS:    FIFO order, each waiter spins on its own queue node
+ *
+ * Waiters arm the exclusive monitor with LDAXR and sleep in WFE. The
+ * holder's release store (STLR) to the watched address clears the monitor,
+ * which generates the wake-up event without an explicit SEV.
+ * ARMv8.1 LSE atomics are used when the compiler targets them.
+ */
+
+/* -------------------- Test-and-set -------------------- */
+void _os_tas_lock(_os_taslock_t *lock)
 {
     unsigned int loaded, status, one = SPINLOCK_LOCKED;
 
-    do {
-        do {
-            __asm__ __volatile__(
-                "ldaxr  %w[loaded], [%[addr]]\n"   // loaded = *lock
-                "cbnz   %w[loaded], 1f\n"          // 이미 잠김이면 건너뛰기
-                "stxr   %w[status], %w[one], [%[addr]]\n" // 시도, status=0이면 성공
-                "1:"
-                : [loaded]"=&r"(loaded), [status]"=&r"(status)
-                : [addr]"r"(lock), [one]"r"(one)
-                : "memory");
-        } while (loaded != 0 || status != 0);
-    } while (0);
+    __asm__ __volatile__(
+        "   sevl\n"                                // 첫 wfe는 바로 통과
+        "1: wfe\n"
+        "2: ldaxr  %w[loaded], [%[addr]]\n"        // loaded = *lock
+        "   cbnz   %w[loaded], 1b\n"               // 이미 잠김이면 이벤트 대기
+        "   stxr   %w[status], %w[one], [%[addr]]\n"
+        "   cbnz   %w[status], 2b\n"               // status=0이면 성공
+        : [loaded]"=&r"(loaded), [status]"=&r"(status)
+        : [addr]"r"(lock), [one]"r"(one)
+        : "memory");
 }
 
 
-void _os_spin_unlock(_os_spinlock_t *lock)
+void _os_tas_unlock(_os_taslock_t *lock)
 {
     __asm__ __volatile__(
         "stlr  wzr, [%0]\n"   // 0 저장 + release barrier
@@ -27,3 +38,303 @@ void _os_spin_unlock(_os_spinlock_t *lock)
         : "r"(lock)
         : "memory");
 }
+
+
+/* -------------------- Ticket -------------------- */
+void _os_ticket_lock(_os_ticketlock_t *lock)
+{
+    int32u_t ticket, owner, tmp;
+    int32u_t inc = 1u << 16;
+
+    /* Takes a ticket: ticket = old value, next += 1 */
+#if defined(__ARM_FEATURE_ATOMICS)
+    __asm__ __volatile__(
+        "ldadda %w[inc], %w[ticket], [%[addr]]\n"
+        : [ticket]"=&r"(ticket)
+        : [addr]"r"(lock), [inc]"r"(inc)
+        : "memory");
+#else
+    int32u_t status;
+    __asm__ __volatile__(
+        "1: ldaxr  %w[ticket], [%[addr]]\n"
+        "   add    %w[tmp], %w[ticket], %w[inc]\n"
+        "   stxr   %w[status], %w[tmp], [%[addr]]\n"
+        "   cbnz   %w[status], 1b\n"
+        : [ticket]"=&r"(ticket), [tmp]"=&r"(tmp), [status]"=&r"(status)
+        : [addr]"r"(lock), [inc]"r"(inc)
+        : "memory");
+#endif
+
+    /* Waits until owner == my ticket */
+    __asm__ __volatile__(
+        "   eor    %w[tmp], %w[ticket], %w[ticket], ror #16\n"
+        "   cbz    %w[tmp], 3f\n"                  // 바로 내 차례
+        "   sevl\n"
+        "2: wfe\n"
+        "   ldaxrh %w[owner], [%[addr]]\n"
+        "   eor    %w[tmp], %w[owner], %w[ticket], lsr #16\n"
+        "   cbnz   %w[tmp], 2b\n"
+        "3:"
+        : [owner]"=&r"(owner), [tmp]"=&r"(tmp)
+        : [addr]"r"(lock), [ticket]"r"(ticket)
+        : "memory");
+}
+
+
+void _os_ticket_unlock(_os_ticketlock_t *lock)
+{
+#if defined(__ARM_FEATURE_ATOMICS)
+    int32u_t one = 1;
+    __asm__ __volatile__(
+        "staddlh %w[one], [%[addr]]\n"
+        :
+        : [addr]"r"(lock), [one]"r"(one)
+        : "memory");
+#else
+    int32u_t owner;
+    __asm__ __volatile__(
+        "ldrh   %w[owner], [%[addr]]\n"
+        "add    %w[owner], %w[owner], #1\n"
+        "stlrh  %w[owner], [%[addr]]\n"            // owner 하프워드만 갱신
+        : [owner]"=&r"(owner)
+        : [addr]"r"(lock)
+        : "memory");
+#endif
+}
+
+
+/* -------------------- MCS -------------------- */
+static inline _os_mcs_node_t *_os_xchg_ptr(_os_mcslock_t *ptr, _os_mcs_node_t *val)
+{
+    _os_mcs_node_t *old;
+#if defined(__ARM_FEATURE_ATOMICS)
+    __asm__ __volatile__(
+        "swpal  %[val], %[old], [%[addr]]\n"
+        : [old]"=&r"(old)
+        : [addr]"r"(ptr), [val]"r"(val)
+        : "memory");
+#else
+    int32u_t status;
+    __asm__ __volatile__(
+        "1: ldaxr  %[old], [%[addr]]\n"
+        "   stlxr  %w[status], %[val], [%[addr]]\n"
+        "   cbnz   %w[status], 1b\n"
+        : [old]"=&r"(old), [status]"=&r"(status)
+        : [addr]"r"(ptr), [val]"r"(val)
+        : "memory");
+#endif
+    return old;
+}
+
+
+static inline _os_mcs_node_t *_os_cas_ptr(_os_mcslock_t *ptr, _os_mcs_node_t *expected, _os_mcs_node_t *desired)
+{
+#if defined(__ARM_FEATURE_ATOMICS)
+    __asm__ __volatile__(
+        "casal  %[old], %[new], [%[addr]]\n"
+        : [old]"+&r"(expected)
+        : [addr]"r"(ptr), [new]"r"(desired)
+        : "memory");
+    return expected;
+#else
+    _os_mcs_node_t *loaded;
+    int32u_t status;
+    __asm__ __volatile__(
+        "1: ldaxr  %[loaded], [%[addr]]\n"
+        "   mov    %w[status], #0\n"
+        "   cmp    %[loaded], %[expected]\n"
+        "   b.ne   2f\n"
+        "   stlxr  %w[status], %[new], [%[addr]]\n"
+        "   cbnz   %w[status], 1b\n"
+        "2:"
+        : [loaded]"=&r"(loaded), [status]"=&r"(status)
+        : [addr]"r"(ptr), [expected]"r"(expected), [new]"r"(desired)
+        : "cc", "memory");
+    return loaded;
+#endif
+}
+
+
+void _os_mcs_lock(_os_mcslock_t *lock, _os_mcs_node_t *node)
+{
+    int32u_t locked;
+
+    node->next = NULL;
+    node->locked = 0;
+
+    /* Appends this node at the tail of the queue */
+    _os_mcs_node_t *prev = _os_xchg_ptr(lock, node);
+    if (prev == NULL) {
+        return;     // The lock was free
+    }
+
+    /* Links behind the predecessor and waits on our own node */
+    __asm__ __volatile__("stlr  %0, [%1]\n" :: "r"(node), "r"(&prev->next) : "memory");
+    __asm__ __volatile__(
+        "   sevl\n"
+        "1: wfe\n"
+        "   ldaxr  %w[locked], [%[addr]]\n"
+        "   cbz    %w[locked], 1b\n"
+        : [locked]"=&r"(locked)
+        : [addr]"r"(&node->locked)
+        : "memory");
+}
+
+
+void _os_mcs_unlock(_os_mcslock_t *lock, _os_mcs_node_t *node)
+{
+    _os_mcs_node_t *next;
+
+    __asm__ __volatile__("ldar  %0, [%1]\n" : "=r"(next) : "r"(&node->next) : "memory");
+    if (next == NULL) {
+        /* No known successor: releases the lock if we are still the tail */
+        if (_os_cas_ptr(lock, node, NULL) == node) {
+            return;
+        }
+        /* A successor is linking itself in: waits for it */
+        __asm__ __volatile__(
+            "   sevl\n"
+            "1: wfe\n"
+            "   ldaxr  %[next], [%[addr]]\n"
+            "   cbz    %[next], 1b\n"
+            : [next]"=&r"(next)
+            : [addr]"r"(&node->next)
+            : "memory");
+    }
+
+    /* Passes the lock: the store wakes the successor spinning on its node */
+    __asm__ __volatile__("stlr  %w0, [%1]\n" :: "r"(1u), "r"(&next->locked) : "memory");
+}
+
+
+/* -------------------- _os_spinlock_t -------------------- */
+#if SPINLOCK_IMPL == SPINLOCK_MCS
+
+/* One node per MCS lock held or awaited by a CPU */
+static _os_mcs_node_t _os_mcs_nodes[MAX_CPUS][EOS_CFG_SPINLOCK_NESTING];
+
+void _os_spin_lock(_os_spinlock_t *lock)
+{
+    _os_mcs_node_t *nodes = _os_mcs_nodes[hal_get_cpu_id()];
+
+    for (int32u_t i = 0; i < EOS_CFG_SPINLOCK_NESTING; i++) {
+        if (nodes[i].lock == NULL) {
+            nodes[i].lock = (void *)lock;
+            _os_mcs_lock(lock, &nodes[i]);
+            return;
+        }
+    }
+
+    /* Nested deeper than configured: there is no node to queue on, and
+     * spinning here with interrupts off would hang the CPU unnoticed */
+    PRINT("MCS nodes exhausted on cpu %u: more than %u nested spinlocks, "
+          "raise EOS_CFG_SPINLOCK_NESTING. System halted.\n",
+          hal_get_cpu_id(), (int32u_t)EOS_CFG_SPINLOCK_NESTING);
+    hal_system_off();
+}
+
+
+void _os_spin_unlock(_os_spinlock_t *lock)
+{
+    _os_mcs_node_t *nodes = _os_mcs_nodes[hal_get_cpu_id()];
+
+    for (int32u_t i = 0; i < EOS_CFG_SPINLOCK_NESTING; i++) {
+        if (nodes[i].lock == (void *)lock) {
+            _os_mcs_unlock(lock, &nodes[i]);
+            nodes[i].lock = NULL;
+            return;
+        }
+    }
+}
+
+#elif SPINLOCK_IMPL == SPINLOCK_TICKET
+
+void _os_spin_lock(_os_spinlock_t *lock)
+{
+    _os_ticket_lock(lock);
+}
+
+
+void _os_spin_unlock(_os_spinlock_t *lock)
+{
+    _os_ticket_unlock(lock);
+}
+
+#else
+
+void _os_spin_lock(_os_spinlock_t *lock)
+{
+    _os_tas_lock(lock);
+}
+
+
+void _os_spin_unlock(_os_spinlock_t *lock)
+{
+    _os_tas_unlock(lock);
+}
+
+#endif
+
+
+/*
+ * Compare-and-swap: stores desired only if *ptr == expected.
+ * Uses the ARMv8.1 LSE CASAL instruction when the compiler targets it
+ * (e.g. -march=armv8.1-a), and an LDAXR/STLXR retry loop otherwise.
+ */
+int32s_t _os_atomic_cas(volatile int32s_t *ptr, int32s_t expected, int32s_t desired)
+{
+#if defined(__ARM_FEATURE_ATOMICS)
+    __asm__ __volatile__(
+        "casal  %w[old], %w[new], [%[addr]]\n"
+        : [old]"+&r"(expected)
+        : [addr]"r"(ptr), [new]"r"(desired)
+        : "memory");
+    return expected;
+#else
+    int32s_t loaded;
+    unsigned int status;
+
+    do {
+        __asm__ __volatile__(
+            "ldaxr  %w[loaded], [%[addr]]\n"        // loaded = *ptr
+            "mov    %w[status], #0\n"
+            "cmp    %w[loaded], %w[expected]\n"
+            "b.ne   1f\n"                           // 값이 다르면 저장하지 않음
+            "stlxr  %w[status], %w[new], [%[addr]]\n"
+            "1:"
+            : [loaded]"=&r"(loaded), [status]"=&r"(status)
+            : [addr]"r"(ptr), [expected]"r"(expected), [new]"r"(desired)
+            : "cc", "memory");
+    } while (status != 0);
+
+    return loaded;
+#endif
+}
+
+
+/* Atomically adds delta to *ptr */
+int32s_t _os_atomic_fetch_add(volatile int32s_t *ptr, int32s_t delta)
+{
+    int32s_t old;
+#if defined(__ARM_FEATURE_ATOMICS)
+    __asm__ __volatile__(
+        "ldaddal %w[delta], %w[old], [%[addr]]\n"
+        : [old]"=&r"(old)
+        : [addr]"r"(ptr), [delta]"r"(delta)
+        : "memory");
+#else
+    int32s_t sum;
+    unsigned int status;
+
+    do {
+        __asm__ __volatile__(
+            "ldaxr  %w[old], [%[addr]]\n"
+            "add    %w[sum], %w[old], %w[delta]\n"
+            "stlxr  %w[status], %w[sum], [%[addr]]\n"
+            : [old]"=&r"(old), [sum]"=&r"(sum), [status]"=&r"(status)
+            : [addr]"r"(ptr), [delta]"r"(delta)
+            : "memory");
+    } while (status != 0);
+#endif
+    return old;
+}
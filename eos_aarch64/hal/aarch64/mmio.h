@@ -2,9 +2,11 @@
 #define MMIO_H_
 #include "type.h"
 
-/* QEMU virt GICv2 base */
+/* QEMU virt GIC bases: the distributor is shared, GICv2 has the
+ * memory-mapped CPU interface, GICv3 a redistributor per CPU */
 #define GICD_BASE   ((addr_t)(int64u_t)0x08000000)
 #define GICC_BASE   ((addr_t)(int64u_t)0x08010000)
+#define GICR_BASE   ((addr_t)(int64u_t)0x080A0000)
 
 
 // Register read
@@ -0,0 +1,93 @@
+#include "type.h"
+#include "pmu.h"
+#include <core/eos_config.h>
+
+/*
+ * PMUv3 on CPU0
+ *     Slot 0 is the cycle counter; slots 1..3 are event counters 0..2
+ *     programmed with common architectural events. A core with fewer
+ *     event counters leaves the last slots at 0. Event and cycle
+ *     filters are 0: EL0 and EL1 are counted, EL2 is not. entry.S has
+ *     already handed all counters to EL1 through MDCR_EL2.HPMN.
+ */
+
+#if EOS_CFG_PMU
+
+#define PMCR_E              (1u << 0)   // enable
+#define PMCR_P              (1u << 1)   // reset event counters
+#define PMCR_C              (1u << 2)   // reset cycle counter
+#define PMCR_LC             (1u << 6)   // 64-bit cycle counter overflow
+#define PMCR_N(pmcr)        (((pmcr) >> 11) & 0x1F)
+#define PMCNTEN_C           (1u << 31)
+
+/* Common event numbers */
+#define EV_INST_RETIRED     0x08
+#define EV_L1D_CACHE_REFILL 0x03
+#define EV_BR_MIS_PRED      0x10
+
+static int32u_t _pmu_slots;             // 0: no PMU
+
+
+_OS_COLD int32u_t hal_pmu_init(void)
+{
+    int64u_t dfr0, pmcr;
+    int32u_t ver, events;
+
+    __asm__ volatile("mrs %0, id_aa64dfr0_el1" : "=r"(dfr0));
+    ver = (int32u_t)(dfr0 >> 8) & 0xF;
+    if (ver == 0 || ver == 0xF) {       // none, or not PMUv3
+        _pmu_slots = 0;
+        return 0;
+    }
+
+    __asm__ volatile("mrs %0, pmcr_el0" : "=r"(pmcr));
+    events = PMCR_N(pmcr);
+    if (events > 3) {
+        events = 3;
+    }
+
+    __asm__ volatile("msr pmcntenclr_el0, %0" :: "r"((int64u_t)0xFFFFFFFFu));
+    __asm__ volatile("msr pmccfiltr_el0, xzr");
+    if (events > 0) {
+        __asm__ volatile("msr pmevtyper0_el0, %0" :: "r"((int64u_t)EV_INST_RETIRED));
+    }
+    if (events > 1) {
+        __asm__ volatile("msr pmevtyper1_el0, %0" :: "r"((int64u_t)EV_L1D_CACHE_REFILL));
+    }
+    if (events > 2) {
+        __asm__ volatile("msr pmevtyper2_el0, %0" :: "r"((int64u_t)EV_BR_MIS_PRED));
+    }
+    __asm__ volatile("msr pmcr_el0, %0" :: "r"(pmcr | PMCR_E | PMCR_P | PMCR_C | PMCR_LC));
+    __asm__ volatile("msr pmcntenset_el0, %0" :: "r"((int64u_t)(PMCNTEN_C | ((1u << events) - 1))));
+    __asm__ volatile("isb");
+
+    _pmu_slots = events + 1;
+    return _pmu_slots;
+}
+
+
+_OS_HOT void hal_pmu_read(int32u_t *counts)
+{
+    int64u_t v;
+
+    counts[0] = counts[1] = counts[2] = counts[3] = 0;
+    if (_pmu_slots == 0) {
+        return;
+    }
+    __asm__ volatile("mrs %0, pmccntr_el0" : "=r"(v));
+    counts[0] = (int32u_t)v;
+    if (_pmu_slots > 1) {
+        __asm__ volatile("mrs %0, pmevcntr0_el0" : "=r"(v));
+        counts[1] = (int32u_t)v;
+    }
+    if (_pmu_slots > 2) {
+        __asm__ volatile("mrs %0, pmevcntr1_el0" : "=r"(v));
+        counts[2] = (int32u_t)v;
+    }
+    if (_pmu_slots > 3) {
+        __asm__ volatile("mrs %0, pmevcntr2_el0" : "=r"(v));
+        counts[3] = (int32u_t)v;
+    }
+}
+
+#endif
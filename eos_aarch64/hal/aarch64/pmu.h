@@ -0,0 +1,17 @@
+#ifndef PMU_H_
+#define PMU_H_
+#include "type.h"
+
+/*
+ * Performance Monitors (PMUv3)
+ *   PMCCNTR_EL0와 이벤트 카운터 3개 (INST_RETIRED, L1D_CACHE_REFILL,
+ *   BR_MIS_PRED)를 EL0/EL1에서 센다. 슬롯 순서는 eos.h의 PMU_*
+ */
+
+/* 카운터를 0부터 켠다: 쓸 수 있는 슬롯 수 (PMU가 없으면 0) */
+int32u_t hal_pmu_init(void);
+
+/* 슬롯마다 현재 값의 하위 32비트 (없는 슬롯은 0) */
+void hal_pmu_read(int32u_t *counts);
+
+#endif  // PMU_H_
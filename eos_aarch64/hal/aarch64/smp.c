@@ -0,0 +1,48 @@
+#include "type.h"
+#include "smp.h"
+
+/* Secondary core entry point (entry.S) */
+extern void _os_secondary_entry(void);
+
+/*
+ * PSCI conduit: QEMU virt uses SMC when virtualization=on (run.sh default),
+ * HVC otherwise. Override with -DPSCI_USE_HVC.
+ */
+static int64u_t psci_call(int64u_t fn, int64u_t a1, int64u_t a2, int64u_t a3)
+{
+    register int64u_t x0 __asm__("x0") = fn;
+    register int64u_t x1 __asm__("x1") = a1;
+    register int64u_t x2 __asm__("x2") = a2;
+    register int64u_t x3 __asm__("x3") = a3;
+
+#ifdef PSCI_USE_HVC
+    __asm__ volatile("hvc #0" : "+r"(x0) : "r"(x1), "r"(x2), "r"(x3) : "memory");
+#else
+    __asm__ volatile("smc #0" : "+r"(x0) : "r"(x1), "r"(x2), "r"(x3) : "memory");
+#endif
+    return x0;
+}
+
+int32s_t hal_start_cpu(int32u_t cpu, _os_cpu_boot_t *boot)
+{
+    if (cpu == 0 || cpu >= MAX_CPUS || !boot) {
+        return -1;
+    }
+
+    // MMU와 캐시가 꺼져 있으므로 boot block은 바로 보임
+    __asm__ volatile("dsb sy" ::: "memory");
+
+    return (int32s_t)psci_call(PSCI_CPU_ON, cpu,
+                               (int64u_t)_os_secondary_entry, (int64u_t)boot);
+}
+
+
+void hal_system_off(void)
+{
+    psci_call(PSCI_SYSTEM_OFF, 0, 0, 0);
+
+    /* Not reached when PSCI is available */
+    while (1) {
+        __asm__ volatile("wfe");
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef SMP_H_
+#define SMP_H_
+#include "type.h"
+
+/* Maximum number of cores the HAL can bring up (QEMU virt: -smp N) */
+#ifndef MAX_CPUS
+#define MAX_CPUS 4
+#endif
+
+/* PSCI function IDs (SMC64 calling convention) */
+#define PSCI_CPU_ON       0xC4000003u
+#define PSCI_SYSTEM_OFF   0x84000008u
+
+/*
+ * Boot block for a secondary core, consumed by _os_secondary_entry.
+ * The core starts on stack_top with all exceptions masked and calls entry(arg).
+ * Field offsets are used by entry.S: keep the layout in sync.
+ */
+typedef struct _os_cpu_boot {
+    int64u_t stack_top;         // offset 0
+    void (*entry)(void *arg);   // offset 8
+    void *arg;                  // offset 16
+} _os_cpu_boot_t;
+
+/* Returns the index of the calling core (MPIDR_EL1.Aff0) */
+static inline int32u_t hal_get_cpu_id(void)
+{
+    int64u_t mpidr;
+    __asm__ volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
+    return (int32u_t)(mpidr & 0xFF);
+}
+
+/* Powers on the given core via PSCI CPU_ON; returns 0 on success */
+int32s_t hal_start_cpu(int32u_t cpu, _os_cpu_boot_t *boot);
+
+/* Powers the machine off via PSCI SYSTEM_OFF (QEMU exits) */
+void hal_system_off(void);
+
+#endif  // SMP_H_
@@ -15,6 +15,13 @@ int64u_t read_cntfrq_el0(void)
     return val;
 }
 
+int64u_t read_cntpct_el0(void)
+{
+    int64u_t val;
+    __asm__ volatile("isb; mrs %0, cntpct_el0" : "=r"(val) :: "memory");
+    return val;
+}
+
 int32u_t read_cntp_ctl_el0(void)
 {
     int64u_t val;
@@ -41,19 +48,87 @@ void write_cntp_ctl_el0(int32u_t val)
     __asm__ volatile("isb");
 }
 
+/* Virtual timer (CNTV): free for user code, e.g. benchmarks */
+int64u_t read_cntvct_el0(void)
+{
+    int64u_t val;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(val) :: "memory");
+    return val;
+}
+
+int64u_t read_cntv_cval_el0(void)
+{
+    int64u_t val;
+    __asm__ volatile("mrs %0, cntv_cval_el0" : "=r"(val));
+    return val;
+}
+
+void write_cntv_cval_el0(int64u_t val)
+{
+    __asm__ volatile("msr cntv_cval_el0, %0" :: "r"(val) : "memory");
+    __asm__ volatile("isb");
+}
+
+void write_cntv_ctl_el0(int32u_t val)
+{
+    __asm__ volatile("msr cntv_ctl_el0, %0" :: "r"((int64u_t)val) : "memory");
+    __asm__ volatile("isb");
+}
+
 /* -------------------- Public HAL functions -------------------- */
 
+/* -------------------- Profiling timer (CNTV) -------------------- */
+static int64u_t _profile_interval;
+
+void hal_profile_timer_start(int32u_t hz)
+{
+    _profile_interval = read_cntfrq_el0() / hz;
+    if (_profile_interval == 0) {
+        _profile_interval = 1;
+    }
+    write_cntv_cval_el0(read_cntvct_el0() + _profile_interval);
+    write_cntv_ctl_el0(1u);
+    hal_enable_irq_line(IRQ_PROFILE);
+}
+
+/* Next compare value one interval on; restarts from now if sampling
+ * fell behind, rather than firing back to back */
+void hal_profile_timer_rearm(void)
+{
+    int64u_t next = read_cntv_cval_el0() + _profile_interval;
+    int64u_t now = read_cntvct_el0();
+
+    write_cntv_cval_el0((long long)(next - now) > 0 ? next : now + _profile_interval);
+}
+
+void hal_profile_timer_stop(void)
+{
+    write_cntv_ctl_el0(0);
+    hal_disable_irq_line(IRQ_PROFILE);
+}
+
+addr_t hal_irq_pc(void)
+{
+    int64u_t elr;
+
+    __asm__ volatile("mrs %0, elr_el1" : "=r"(elr));
+    return (addr_t)elr;
+}
+
 /* Re-arm the timer interrupt by reloading CNTP_TVAL_EL0 */
 void _timer_rearm(void)
 {
     write_cntp_tval_el0(_reload);
 }
 
-/* Initialize Generic Timer (CNTP) and enable its interrupt */
+/* Initialize the GIC and the Generic Timer (CNTP), and enable its interrupt */
 void _os_init_hal(void)
 {
     int64u_t freq = read_cntfrq_el0();  // usually 62500000 on QEMU virt
 
+    // 0) GIC 초기화
+    _gic_init();
+
     // 1초 틱(TICK_HZ=1) 기본. 나중에 TICK_HZ만 바꾸면 자동 반영됨.
     if ((int32u_t)TICK_HZ == 0u) {
         _reload = (int32u_t)freq;                  // 방어: 0이면 강제로 1Hz로
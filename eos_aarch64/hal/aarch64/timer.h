@@ -1,23 +1,46 @@
 #ifndef TIMER_H_
 #define TIMER_H_
 #include "type.h"
+#include <core/eos_config.h>
 
-#ifndef TICK_HZ
-#define TICK_HZ 1u
-#endif
+#define TICK_HZ EOS_CFG_TICK_HZ
 
 /* CNTP PPI interrupt ID (GICv2 on ARMv8) */
 #ifndef IRQ_CNTP
 #define IRQ_CNTP 30
 #endif
 
+/* System tick interrupt used by the core */
+#define IRQ_TICK IRQ_CNTP
+
 int64u_t read_cntfrq_el0(void);
+int64u_t read_cntpct_el0(void);
 int32u_t read_cntp_ctl_el0(void);
 int32u_t read_cntp_tval_el0(void);
 
 void write_cntp_tval_el0(int32u_t val);
 void write_cntp_ctl_el0(int32u_t val);
 
+/* CNTV PPI interrupt ID */
+#ifndef IRQ_CNTV
+#define IRQ_CNTV 27
+#endif
+
+int64u_t read_cntvct_el0(void);
+int64u_t read_cntv_cval_el0(void);
+void write_cntv_cval_el0(int64u_t val);
+void write_cntv_ctl_el0(int32u_t val);
+
+/* Profiling timer: the virtual timer, so CNTP keeps the system tick */
+#define IRQ_PROFILE IRQ_CNTV
+
+void hal_profile_timer_start(int32u_t hz);
+void hal_profile_timer_rearm(void);
+void hal_profile_timer_stop(void);
+
+/* PC the current interrupt stopped (ELR_EL1) */
+addr_t hal_irq_pc(void);
+
 /* Initialize the Generic Timer */
 void _os_init_hal(void);
 
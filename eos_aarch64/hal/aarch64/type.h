@@ -1,5 +1,5 @@
 /********************************************************
- * Filename: hal/linux/type.h
+ * Filename: hal/aarch64/type.h
  * 
  * Author: wsyoo, RTOSLab. SNU.
  * 
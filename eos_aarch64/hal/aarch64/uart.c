@@ -10,6 +10,7 @@
 
 #include "uart.h"
 #include "mmio.h"
+#include "interrupt.h"
 #include <stdarg.h>
 
 /* QEMU virt: ARM PL011 base */
@@ -30,7 +31,14 @@
 #define UARTICR     0x44    // Interrupt Clear Register
 
 /* 비트 정의 */
+#define FR_RXFE     (1u << 4)      /* Receive FIFO empty */
 #define FR_TXFF     (1u << 5)      /* Transmit FIFO full */
+#define DR_ERRORS   (0xFu << 8)    /* FE, PE, BE, OE (UART_RX_* 순서) */
+#define IFLS_RX_1_2 (2u << 3)      /* RX 인터럽트: FIFO 1/2 이상 */
+#define IFLS_TX_1_2 (2u << 0)
+#define INT_RX      (1u << 4)      /* RX FIFO level */
+#define INT_RT      (1u << 6)      /* Receive timeout: FIFO에 데이터가 남은 채 32비트 시간 idle */
+#define INT_RX_ERRS (0xFu << 7)    /* FE, PE, BE, OE */
 #define LCRH_FEN    (1u << 4)      /* FIFO enable */
 #define LCRH_WLEN_8 (3u << 5)      /* 8-bit word length */
 #define CR_UARTEN   (1u << 0)      /* UART enable */
@@ -73,10 +81,47 @@ void early_uart_init(int32u_t uart_clk_hz)
     /* 5) 폴링 TX/RX 활성 + UART enable */
     mmio_write32(base + UARTCR, CR_UARTEN | CR_TXE | CR_RXE);
 
-    /* 6) 인터럽트는 사용하지 않음(폴링 모드) */
+    /* 6) 인터럽트는 일단 모두 마스크: 송신은 폴링, 수신은 hal_uart_rx_init()에서 */
     mmio_write32(base + UARTIMSC, 0);
 }
 
+/*
+ * 인터럽트 기반 수신
+ *   FIFO가 1/2 차거나 버스트 끝에서 수신 타임아웃이 나면 한 번 인터럽트:
+ *   핸들러는 FIFO를 끝까지 비우므로 버스트 하나에 인터럽트 몇 번이면 충분
+ */
+void hal_uart_rx_init(void)
+{
+    addr_t base = (addr_t)UART0_BASE;
+
+    mmio_write32(base + UARTIFLS, IFLS_RX_1_2 | IFLS_TX_1_2);
+    mmio_write32(base + UARTICR, INT_RX | INT_RT | INT_RX_ERRS);
+    mmio_write32(base + UARTIMSC, INT_RX | INT_RT | INT_RX_ERRS);
+
+    hal_enable_irq_line(IRQ_UART0);
+}
+
+
+int32s_t hal_uart_getc(int32u_t *err)
+{
+    addr_t base = (addr_t)UART0_BASE;
+    int32u_t dr;
+
+    if (mmio_read32(base + UARTFR) & FR_RXFE) {
+        return -1;
+    }
+    dr = mmio_read32(base + UARTDR);
+    *err = (dr & DR_ERRORS) >> 8;
+    return (int32s_t)(dr & 0xFFu);
+}
+
+
+void hal_uart_rx_ack(void)
+{
+    mmio_write32((addr_t)UART0_BASE + UARTICR, INT_RX | INT_RT | INT_RX_ERRS);
+}
+
+
 void early_uart_putc(char c)
 {
     addr_t base = (addr_t)UART0_BASE;
@@ -28,4 +28,16 @@ void uart_put_dec(int64u_t val);
 
 void _os_serial_printf(const char *fmt, ...);
 
+/* PL011 UART0 interrupt on QEMU virt (SPI 1) */
+#define IRQ_UART0 33
+
+/* 수신 인터럽트 활성화: RX FIFO 1/2 레벨 + 수신 타임아웃 + 에러 */
+void hal_uart_rx_init(void);
+
+/* RX FIFO에서 한 글자: 비었으면 -1, *err = UART_RX_* 에러 비트 */
+int32s_t hal_uart_getc(int32u_t *err);
+
+/* 수신 인터럽트 클리어 (FIFO를 비운 뒤 호출) */
+void hal_uart_rx_ack(void);
+
 #endif  // EARLY_UART_H_
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <core/eos.h>
+#include "interrupt.h"
+#include "blk.h"
+
+/*
+ * Block device backed by an image file
+ *     Requests wait in a FIFO until the IRQ_BLK "interrupt", which
+ *     performs them in order, so completions arrive asynchronously and
+ *     batched as on the virtio-blk HAL.
+ */
+
+#if EOS_CFG_BLK
+
+typedef struct host_blk_req {
+    int8u_t op;
+    int64u_t sector;
+    void *buf;
+    int32u_t len;
+    void *tag;
+} host_blk_req_t;
+
+static host_blk_req_t _blk_queue[EOS_CFG_BLK_QUEUE_DEPTH];
+static int32u_t _blk_head, _blk_tail;   // free-running FIFO indexes
+static int _blk_fd = -1;
+static int64u_t _blk_sectors;
+
+
+int32s_t hal_blk_init(void)
+{
+    const char *path = getenv("EOS_DISK");
+    struct stat st;
+
+    if (path == NULL) {
+        return -1;
+    }
+    _blk_fd = open(path, O_RDWR);
+    if (_blk_fd < 0 || fstat(_blk_fd, &st) < 0) {
+        PRINT("cannot open disk image %s\n", path);
+        return -1;
+    }
+    _blk_sectors = (int64u_t)st.st_size / BLK_SECTOR_SIZE;
+    _blk_head = _blk_tail = 0;
+
+    _host_irq_attach(SIGUSR2, IRQ_BLK);
+    return IRQ_BLK;
+}
+
+
+int64u_t hal_blk_capacity(void)
+{
+    return _blk_sectors;
+}
+
+
+void hal_blk_enqueue(int8u_t op, int64u_t sector, void *buf, int32u_t len, void *tag)
+{
+    host_blk_req_t *r = &_blk_queue[_blk_tail++ % EOS_CFG_BLK_QUEUE_DEPTH];
+
+    r->op = op;
+    r->sector = sector;
+    r->buf = buf;
+    r->len = len;
+    r->tag = tag;
+}
+
+
+void hal_blk_kick(void)
+{
+    raise(SIGUSR2);
+}
+
+
+void hal_blk_reap(void)
+{
+    while (_blk_head != _blk_tail) {
+        host_blk_req_t r = _blk_queue[_blk_head++ % EOS_CFG_BLK_QUEUE_DEPTH];
+        off_t off = (off_t)(r.sector * BLK_SECTOR_SIZE);
+        int8u_t status;
+
+        if (r.op == BLK_READ) {
+            status = pread(_blk_fd, r.buf, r.len, off) == (ssize_t)r.len ? BLK_OK : BLK_IOERR;
+        } else if (r.op == BLK_WRITE) {
+            status = pwrite(_blk_fd, r.buf, r.len, off) == (ssize_t)r.len ? BLK_OK : BLK_IOERR;
+        } else {
+            status = fdatasync(_blk_fd) == 0 ? BLK_OK : BLK_IOERR;
+        }
+        _os_blk_complete(r.tag, status);
+    }
+}
+
+#endif
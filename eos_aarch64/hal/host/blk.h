@@ -0,0 +1,27 @@
+#ifndef BLK_H_
+#define BLK_H_
+#include "type.h"
+
+/*
+ * The disk on the host is the image file named by $EOS_DISK: requests
+ * are carried out with pread/pwrite when SIGUSR2, raised by
+ * hal_blk_kick(), is delivered as this IRQ line
+ */
+#define IRQ_BLK 2
+
+/* Opens $EOS_DISK; returns IRQ_BLK, or -1 without a disk */
+int32s_t hal_blk_init(void);
+
+/* Size of the image in 512-byte sectors */
+int64u_t hal_blk_capacity(void);
+
+/* Queues one request; called with interrupts off and a free slot */
+void hal_blk_enqueue(int8u_t op, int64u_t sector, void *buf, int32u_t len, void *tag);
+
+/* Raises the completion signal for everything queued so far */
+void hal_blk_kick(void);
+
+/* Signal handler side: runs the queued requests, _os_blk_complete() for each */
+void hal_blk_reap(void);
+
+#endif  // BLK_H_
@@ -0,0 +1,53 @@
+#include <signal.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "type.h"
+#include "context.h"
+
+_os_context_t *_os_running_context;
+
+/* First code run by every task: calls entry(arg) on the task's stack */
+static void _os_task_start(void)
+{
+    _os_context_t *ctx = _os_running_context;
+
+    ctx->entry(ctx->arg);
+
+    /* Tasks are not supposed to return */
+    static const char msg[] = "[hal/host] task returned from its entry function\n";
+    write(STDOUT_FILENO, msg, sizeof(msg) - 1);
+    while (1) {
+        pause();
+    }
+}
+
+addr_t _os_create_context(addr_t stack_base, size_t stack_size, void (*entry)(void *), void *arg)
+{
+    // 1) 스택 블록의 맨 위에 16B 정렬된 컨텍스트 배치
+    int64u_t top = ((int64u_t)stack_base + (int64u_t)stack_size) & ~0xFULL;
+    _os_context_t *ctx = (_os_context_t *)((top - sizeof(_os_context_t)) & ~0xFULL);
+
+    // 2) 나머지 영역을 태스크 스택으로 사용
+    getcontext(&ctx->uc);
+    ctx->uc.uc_stack.ss_sp = stack_base;
+    ctx->uc.uc_stack.ss_size = (size_t)((int64u_t)ctx - (int64u_t)stack_base);
+    ctx->uc.uc_link = NULL;
+    sigemptyset(&ctx->uc.uc_sigmask);   // 인터럽트(시그널) 허용 상태로 시작
+    ctx->resumed = 0;
+    ctx->entry = entry;
+    ctx->arg = arg;
+    makecontext(&ctx->uc, _os_task_start, 0);
+
+    return (addr_t)ctx;
+}
+
+void _os_restore_and_eret(addr_t sp)
+{
+    _os_context_t *ctx = (_os_context_t *)sp;
+
+    _os_running_context = ctx;
+    ctx->resumed = 1;
+    setcontext(&ctx->uc);
+
+    /* Never reaches here */
+}
@@ -0,0 +1,36 @@
+#ifndef CONTEXT_H_
+#define CONTEXT_H_
+#include <ucontext.h>
+#include "type.h"
+
+/*
+ * Task context on the host: a ucontext_t kept at the top of the task's
+ * stack block. Signal masks are part of the context, so a task resumes
+ * with the interrupt state it was saved with.
+ */
+typedef struct _os_context {
+    ucontext_t uc;
+    volatile int32u_t resumed;  // set by _os_restore_and_eret before resuming
+    void (*entry)(void *arg);
+    void *arg;
+} _os_context_t;
+
+/* Context of the task currently on the CPU */
+extern _os_context_t *_os_running_context;
+
+/*
+ * getcontext() returns a second time when the context is resumed, so the
+ * save must expand in the caller's frame (eos_schedule). It yields the
+ * context address on the first return and 0 when resumed.
+ */
+#define _os_save_context() ({                                   \
+    _os_context_t *__ctx = _os_running_context;                 \
+    __ctx->resumed = 0;                                         \
+    getcontext(&__ctx->uc);                                     \
+    __ctx->resumed ? (addr_t)0 : (addr_t)__ctx; })
+
+addr_t _os_create_context(addr_t stack_base, size_t stack_size, void (*entry)(void *), void *arg);
+
+void _os_restore_and_eret(addr_t sp);
+
+#endif // CONTEXT_H_
@@ -0,0 +1,149 @@
+#define _GNU_SOURCE
+#include <signal.h>
+#include <ucontext.h>
+#include <time.h>
+#include "type.h"
+#include "interrupt.h"
+#include <core/eos_config.h>
+
+#define HOST_IRQ_LINES 32
+
+void _os_common_interrupt_handler(int32u_t irq, addr_t saved_context_ptr);
+
+/* -------------------- Internal state -------------------- */
+static sigset_t _irq_signals;                   // signals standing for IRQ lines
+static int _irq_of_signal[NSIG];                // signal -> irq, -1 if unmapped
+static volatile int32u_t _irq_line_enabled;     // bit n: line n enabled
+static volatile int32s_t _irq_active = -1;      // irq being serviced
+
+
+static addr_t _irq_pc;                          // PC the signal stopped
+
+
+static void _host_signal_handler(int signo, siginfo_t *info, void *ucontext)
+{
+    int32s_t irq = _irq_of_signal[signo];
+    ucontext_t *uc = (ucontext_t *)ucontext;
+
+    if (irq < 0 || !(_irq_line_enabled & (1u << irq))) {
+        return;
+    }
+
+#if defined(__x86_64__)
+    _irq_pc = (addr_t)uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+    _irq_pc = (addr_t)uc->uc_mcontext.pc;
+#else
+    _irq_pc = 0;
+    (void)uc;
+#endif
+
+    // 시그널 핸들러가 실행되는 동안 IRQ 시그널은 모두 block 상태
+    _irq_active = irq;
+    _os_common_interrupt_handler((int32u_t)irq, NULL);
+    _irq_active = -1;
+}
+
+/* -------------------- Initialization -------------------- */
+void _host_irq_init(void)
+{
+    sigemptyset(&_irq_signals);
+    for (int i = 0; i < NSIG; i++) {
+        _irq_of_signal[i] = -1;
+    }
+    _irq_line_enabled = 0;
+}
+
+void _host_irq_attach(int signo, int32u_t irq)
+{
+    struct sigaction sa;
+
+    _irq_of_signal[signo] = (int)irq;
+    sigaddset(&_irq_signals, signo);
+
+    sa.sa_sigaction = _host_signal_handler;
+    sa.sa_mask = _irq_signals;      // 핸들러 실행 중 모든 IRQ 시그널 차단
+    sa.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigaction(signo, &sa, NULL);
+}
+
+/* Signals drained by hal_get_irq() report the PC of the first one */
+addr_t hal_irq_pc(void)
+{
+    return _irq_pc;
+}
+
+/* -------------------- IRQ line control -------------------- */
+void hal_enable_irq_line(int32s_t irq)
+{
+    if (irq >= 0 && irq < HOST_IRQ_LINES) {
+        _irq_line_enabled |= 1u << irq;
+    }
+}
+
+void hal_disable_irq_line(int32s_t irq)
+{
+    if (irq >= 0 && irq < HOST_IRQ_LINES) {
+        _irq_line_enabled &= ~(1u << irq);
+    }
+}
+
+/* -------------------- CPU Interrupt control -------------------- */
+_OS_HOT void hal_enable_interrupt(void)
+{
+    sigprocmask(SIG_UNBLOCK, &_irq_signals, NULL);
+}
+
+/* Returns 1 if interrupts were enabled */
+_OS_HOT int32u_t hal_disable_interrupt(void)
+{
+    sigset_t prev;
+
+    sigprocmask(SIG_BLOCK, &_irq_signals, &prev);
+    for (int i = 1; i < NSIG; i++) {
+        if (_irq_of_signal[i] >= 0) {
+            return sigismember(&prev, i) ? 0 : 1;
+        }
+    }
+    return 0;
+}
+
+_OS_HOT void hal_restore_interrupt(int32u_t flag)
+{
+    if (flag) {
+        hal_enable_interrupt();
+    }
+}
+
+/* -------------------- IRQ acknowledge -------------------- */
+/* Takes a signal that became pending while the handler ran (IRQ signals
+ * are blocked there) on an enabled line; -1 if there is none */
+_OS_HOT int32s_t hal_get_irq(void)
+{
+    static const struct timespec no_wait = { 0, 0 };
+    sigset_t pending, one;
+
+    if (sigpending(&pending) < 0) {
+        return -1;
+    }
+    for (int i = 1; i < NSIG; i++) {
+        int32s_t irq = _irq_of_signal[i];
+
+        if (irq < 0 || !(_irq_line_enabled & (1u << irq)) || !sigismember(&pending, i)) {
+            continue;
+        }
+        sigemptyset(&one);
+        sigaddset(&one, i);
+        if (sigtimedwait(&one, NULL, &no_wait) == i) {
+            _irq_active = irq;
+            return irq;
+        }
+    }
+    return -1;
+}
+
+_OS_HOT void hal_ack_irq(int32u_t irq)
+{
+    /* Signals need no acknowledgement */
+    (void)irq;
+}
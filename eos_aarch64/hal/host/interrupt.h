@@ -0,0 +1,26 @@
+#ifndef INTERRUPT_H_
+#define INTERRUPT_H_
+#include "type.h"
+
+/*
+ * Interrupts on the host are POSIX signals. Masking interrupts blocks
+ * the signals that stand for IRQ lines; the line-enable mask decides
+ * whether a delivered signal is dispatched to the core.
+ */
+
+/* Installs the signal handlers with all IRQ lines disabled */
+void _host_irq_init(void);
+
+/* Maps a signal to an IRQ line; delivered through _os_common_interrupt_handler */
+void _host_irq_attach(int signo, int32u_t irq);
+
+void hal_enable_irq_line(int32s_t irq);
+void hal_disable_irq_line(int32s_t irq);
+void hal_enable_interrupt(void);
+int32u_t hal_disable_interrupt(void);
+void hal_restore_interrupt(int32u_t flag);
+
+int32s_t hal_get_irq(void);
+void hal_ack_irq(int32u_t irq);
+
+#endif // INTERRUPT_H_
@@ -0,0 +1,135 @@
+#include <core/eos.h>
+
+/*
+ * Spinlocks and atomics for the host HAL, built on the compiler's
+ * __atomic builtins. The kernel runs on one thread, so waiting only
+ * happens if a lock is misused; waiters simply spin.
+ */
+
+/* -------------------- Test-and-set -------------------- */
+void _os_tas_lock(_os_taslock_t *lock)
+{
+    while (__atomic_exchange_n(lock, SPINLOCK_LOCKED, __ATOMIC_ACQUIRE) != SPINLOCK_UNLOCKED) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED) != SPINLOCK_UNLOCKED) { }
+    }
+}
+
+
+void _os_tas_unlock(_os_taslock_t *lock)
+{
+    __atomic_store_n(lock, SPINLOCK_UNLOCKED, __ATOMIC_RELEASE);
+}
+
+
+/* -------------------- Ticket -------------------- */
+void _os_ticket_lock(_os_ticketlock_t *lock)
+{
+    int32u_t ticket = __atomic_fetch_add(lock, 1u << 16, __ATOMIC_ACQUIRE) >> 16;
+
+    while ((__atomic_load_n(lock, __ATOMIC_ACQUIRE) & 0xFFFFu) != ticket) { }
+}
+
+
+void _os_ticket_unlock(_os_ticketlock_t *lock)
+{
+    int32u_t val = __atomic_load_n(lock, __ATOMIC_RELAXED);
+    int32u_t owner = (val + 1) & 0xFFFFu;
+
+    /* Only the holder changes the owner half; retry if next moved */
+    while (!__atomic_compare_exchange_n(lock, &val, (val & 0xFFFF0000u) | owner,
+                                        0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        owner = (val + 1) & 0xFFFFu;
+    }
+}
+
+
+/* -------------------- MCS -------------------- */
+void _os_mcs_lock(_os_mcslock_t *lock, _os_mcs_node_t *node)
+{
+    node->next = NULL;
+    node->locked = 0;
+
+    _os_mcs_node_t *prev = __atomic_exchange_n(lock, node, __ATOMIC_ACQ_REL);
+    if (prev == NULL) {
+        return;
+    }
+
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE)) { }
+}
+
+
+void _os_mcs_unlock(_os_mcslock_t *lock, _os_mcs_node_t *node)
+{
+    _os_mcs_node_t *next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+
+    if (next == NULL) {
+        _os_mcs_node_t *expected = node;
+        if (__atomic_compare_exchange_n(lock, &expected, NULL, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+        while ((next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)) == NULL) { }
+    }
+    __atomic_store_n(&next->locked, 1, __ATOMIC_RELEASE);
+}
+
+
+/* -------------------- _os_spinlock_t -------------------- */
+#if SPINLOCK_IMPL == SPINLOCK_MCS
+
+static _os_mcs_node_t _os_mcs_node;
+
+void _os_spin_lock(_os_spinlock_t *lock)
+{
+    _os_mcs_lock(lock, &_os_mcs_node);
+}
+
+
+void _os_spin_unlock(_os_spinlock_t *lock)
+{
+    _os_mcs_unlock(lock, &_os_mcs_node);
+}
+
+#elif SPINLOCK_IMPL == SPINLOCK_TICKET
+
+void _os_spin_lock(_os_spinlock_t *lock)
+{
+    _os_ticket_lock(lock);
+}
+
+
+void _os_spin_unlock(_os_spinlock_t *lock)
+{
+    _os_ticket_unlock(lock);
+}
+
+#else
+
+void _os_spin_lock(_os_spinlock_t *lock)
+{
+    _os_tas_lock(lock);
+}
+
+
+void _os_spin_unlock(_os_spinlock_t *lock)
+{
+    _os_tas_unlock(lock);
+}
+
+#endif
+
+
+/* -------------------- Atomics -------------------- */
+int32s_t _os_atomic_cas(volatile int32s_t *ptr, int32s_t expected, int32s_t desired)
+{
+    __atomic_compare_exchange_n(ptr, &expected, desired, 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return expected;
+}
+
+
+int32s_t _os_atomic_fetch_add(volatile int32s_t *ptr, int32s_t delta)
+{
+    return __atomic_fetch_add(ptr, delta, __ATOMIC_ACQ_REL);
+}
@@ -0,0 +1,10 @@
+void _os_init();
+
+/* Process entry: plays the role of entry.S on the target */
+int main(void)
+{
+    _os_init();
+
+    /* Never reaches here */
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <core/eos.h>
+#include "pmu.h"
+
+/*
+ * Each slot is an independent perf event on this thread, read with
+ * read(2) (async-signal-safe, so IRQ paths may sample it too)
+ */
+
+#if EOS_CFG_PMU
+
+static const struct {
+    int32u_t type;
+    int64u_t config;
+} _pmu_events[PMU_COUNTERS] = {
+    [PMU_CYCLES]        = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PMU_INSTRUCTIONS]  = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PMU_L1D_MISSES]    = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    [PMU_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static int _pmu_fd[PMU_COUNTERS];
+
+
+int32u_t hal_pmu_init(void)
+{
+    struct perf_event_attr attr;
+    int32u_t n = 0;
+
+    for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = _pmu_events[i].type;
+        attr.config = _pmu_events[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        _pmu_fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (_pmu_fd[i] >= 0) {
+            n++;
+        }
+    }
+    return n;
+}
+
+
+void hal_pmu_read(int32u_t *counts)
+{
+    for (int32u_t i = 0; i < PMU_COUNTERS; i++) {
+        int64u_t v = 0;
+
+        if (_pmu_fd[i] >= 0) {
+            if (read(_pmu_fd[i], &v, sizeof(v)) != sizeof(v)) {
+                v = 0;
+            }
+        } else if (i == PMU_CYCLES) {
+            v = read_cntpct_el0();
+        }
+        counts[i] = (int32u_t)v;
+    }
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef PMU_H_
+#define PMU_H_
+#include "type.h"
+
+/*
+ * PMU on the host: Linux perf counters of this process (user space
+ * only), one per slot of eos.h's PMU_*. Where perf is unavailable the
+ * cycle slot falls back to CLOCK_MONOTONIC nanoseconds and the event
+ * slots read 0.
+ */
+
+/* Opens the counters; returns how many slots count real events */
+int32u_t hal_pmu_init(void);
+
+/* Low 32 bits of every slot */
+void hal_pmu_read(int32u_t *counts);
+
+#endif  // PMU_H_
@@ -0,0 +1,51 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "type.h"
+#include "interrupt.h"
+#include "uart.h"
+
+/* write(2) is async-signal-safe, so printing from the tick handler is fine */
+void _os_serial_puts(const char *s)
+{
+    if (!s) return;
+    write(STDOUT_FILENO, s, strlen(s));
+}
+
+
+void hal_uart_rx_init(void)
+{
+    int flags = fcntl(STDIN_FILENO, F_GETFL);
+
+    _host_irq_attach(SIGIO, IRQ_UART0);
+    if (flags >= 0) {
+        fcntl(STDIN_FILENO, F_SETOWN, getpid());
+        fcntl(STDIN_FILENO, F_SETFL, flags | O_ASYNC);
+    }
+    hal_enable_irq_line(IRQ_UART0);
+}
+
+
+/* stdin stays blocking (it may be shared with the shell): FIONREAD
+ * tells whether a read would return at once */
+int32s_t hal_uart_getc(int32u_t *err)
+{
+    int avail = 0;
+    unsigned char c;
+
+    *err = 0;
+    if (ioctl(STDIN_FILENO, FIONREAD, &avail) < 0 || avail <= 0) {
+        return -1;
+    }
+    if (read(STDIN_FILENO, &c, 1) != 1) {
+        return -1;
+    }
+    return c;
+}
+
+
+void hal_uart_rx_ack(void)
+{
+}
@@ -0,0 +1,15 @@
+#include <stdlib.h>
+#include "type.h"
+#include "smp.h"
+
+int32s_t hal_start_cpu(int32u_t cpu, _os_cpu_boot_t *boot)
+{
+    (void)cpu;
+    (void)boot;
+    return -1;
+}
+
+void hal_system_off(void)
+{
+    exit(0);
+}
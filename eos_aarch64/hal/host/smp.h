@@ -0,0 +1,27 @@
+#ifndef SMP_H_
+#define SMP_H_
+#include "type.h"
+
+/* The host HAL runs the kernel on a single thread */
+#ifndef MAX_CPUS
+#define MAX_CPUS 1
+#endif
+
+typedef struct _os_cpu_boot {
+    int64u_t stack_top;
+    void (*entry)(void *arg);
+    void *arg;
+} _os_cpu_boot_t;
+
+static inline int32u_t hal_get_cpu_id(void)
+{
+    return 0;
+}
+
+/* Secondary cores are not available: always fails */
+int32s_t hal_start_cpu(int32u_t cpu, _os_cpu_boot_t *boot);
+
+/* Exits the process */
+void hal_system_off(void);
+
+#endif  // SMP_H_
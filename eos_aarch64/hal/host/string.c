@@ -0,0 +1,23 @@
+#include <string.h>
+#include <core/eos.h>
+
+/*
+ * Kernel memcpy / memmove / memset
+ *     On the host the C library already provides tuned versions.
+ */
+_OS_HOT void *_os_memcpy(void *dst, const void *src, size_t n)
+{
+    return memcpy(dst, src, n);
+}
+
+
+_OS_HOT void *_os_memmove(void *dst, const void *src, size_t n)
+{
+    return memmove(dst, src, n);
+}
+
+
+_OS_HOT void *_os_memset(void *dst, int32s_t val, size_t n)
+{
+    return memset(dst, val, n);
+}
@@ -0,0 +1,74 @@
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+#include "type.h"
+#include "interrupt.h"
+#include "timer.h"
+
+#define NSEC_PER_SEC 1000000000ULL
+
+/* -------------------- Counter -------------------- */
+int64u_t read_cntfrq_el0(void)
+{
+    return NSEC_PER_SEC;
+}
+
+int64u_t read_cntpct_el0(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64u_t)ts.tv_sec * NSEC_PER_SEC + (int64u_t)ts.tv_nsec;
+}
+
+/* -------------------- Public HAL functions -------------------- */
+void _timer_rearm(void)
+{
+}
+
+/* -------------------- Profiling timer -------------------- */
+static void _set_interval(int which, int64u_t period_us)
+{
+    struct itimerval it;
+
+    it.it_interval.tv_sec = period_us / 1000000ULL;
+    it.it_interval.tv_usec = period_us % 1000000ULL;
+    it.it_value = it.it_interval;
+    setitimer(which, &it, NULL);
+}
+
+void hal_profile_timer_start(int32u_t hz)
+{
+    int64u_t period_us = 1000000ULL / hz;
+
+    _host_irq_attach(SIGPROF, IRQ_PROFILE);
+    hal_enable_irq_line(IRQ_PROFILE);
+    _set_interval(ITIMER_PROF, period_us ? period_us : 1);
+}
+
+void hal_profile_timer_rearm(void)
+{
+}
+
+void hal_profile_timer_stop(void)
+{
+    _set_interval(ITIMER_PROF, 0);
+    hal_disable_irq_line(IRQ_PROFILE);
+}
+
+/* Starts a periodic SIGALRM at TICK_HZ and enables its IRQ line */
+void _os_init_hal(void)
+{
+    int64u_t period_us = 1000000ULL / (TICK_HZ ? TICK_HZ : 1u);
+
+    if (period_us == 0) {
+        period_us = 1;
+    }
+
+    _host_irq_init();
+    _host_irq_attach(SIGALRM, IRQ_TICK);
+
+    _set_interval(ITIMER_REAL, period_us);
+
+    hal_enable_irq_line(IRQ_TICK);
+}
@@ -0,0 +1,35 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+#include "type.h"
+#include <core/eos_config.h>
+
+#define TICK_HZ EOS_CFG_TICK_HZ
+
+/* System tick: SIGALRM from an interval timer, delivered as this IRQ */
+#define IRQ_TICK 0
+
+/*
+ * Counter with the same interface as the aarch64 generic timer so that
+ * core code can sample it; it counts nanoseconds of CLOCK_MONOTONIC
+ */
+int64u_t read_cntfrq_el0(void);
+int64u_t read_cntpct_el0(void);
+
+/* Profiling timer: SIGPROF from ITIMER_PROF, which runs on the CPU
+ * time of the process, delivered as this IRQ */
+#define IRQ_PROFILE 3
+
+void hal_profile_timer_start(int32u_t hz);
+void hal_profile_timer_rearm(void);
+void hal_profile_timer_stop(void);
+
+/* PC the current interrupt (signal) stopped */
+addr_t hal_irq_pc(void);
+
+/* Initializes the interrupt emulation and starts the tick */
+void _os_init_hal(void);
+
+/* Rearm the timer for the next tick (the interval timer is periodic) */
+void _timer_rearm(void);
+
+#endif  // TIMER_H_
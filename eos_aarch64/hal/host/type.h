@@ -0,0 +1,22 @@
+/********************************************************
+ * Filename: hal/host/type.h
+ *
+ * Description: data type definitions for the host HAL
+ ********************************************************/
+#ifndef TYPE_H_
+#define TYPE_H_
+#include <stddef.h>     // size_t comes from libc on the host
+
+typedef unsigned char	    bool_t;
+typedef unsigned char	    int8u_t;
+typedef signed char		    int8s_t;
+typedef unsigned short	    int16u_t;
+typedef signed short	    int16s_t;
+typedef unsigned int	    int32u_t;
+typedef signed int		    int32s_t;
+typedef unsigned long long  int64u_t;
+typedef float			    fp32_t;
+typedef double			    fp64_t;
+typedef void			    *addr_t;
+
+#endif // TYPE_H_
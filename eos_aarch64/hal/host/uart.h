@@ -0,0 +1,20 @@
+#ifndef UART_H_
+#define UART_H_
+#include "type.h"
+
+/*
+ * Console input on the host is stdin: SIGIO (O_ASYNC) stands for the
+ * UART receive interrupt and is delivered as this IRQ line
+ */
+#define IRQ_UART0 1
+
+/* Turns on SIGIO for stdin and enables the IRQ line */
+void hal_uart_rx_init(void);
+
+/* Next byte available on stdin without blocking, -1 if none; *err is always 0 */
+int32s_t hal_uart_getc(int32u_t *err);
+
+/* Nothing to clear: SIGIO is edge-triggered */
+void hal_uart_rx_ack(void);
+
+#endif  // UART_H_
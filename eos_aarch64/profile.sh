@@ -0,0 +1,67 @@
+#!/bin/bash
+#
+# Flat profiles from the PROF lines printed by eos_profile_dump():
+# samples per function (interrupted PC) and per task (TCB symbol),
+# symbolized against the eos ELF
+#
+#   ./run.sh | tee log.txt                # then "profile" on the console
+#   ./profile.sh log.txt [eos]
+#
+# Only the last dump in the log is used.
+#
+set -e
+
+LOG=${1:?usage: $0 <log> [elf]}
+ELF=${2:-eos}
+NM=${NM:-nm}
+
+"$NM" -n --defined-only "$ELF" | tr -d '\r' | awk '
+    function hex(s,    i, c, v) {
+        sub(/^0x/, "", s); v = 0
+        for (i = 1; i <= length(s); i++) {
+            c = index("0123456789abcdef", tolower(substr(s, i, 1))) - 1
+            v = v * 16 + c
+        }
+        return v
+    }
+    # Last symbol at or below a, or "?"
+    function lookup(addr, names, addrs, n,    lo, hi, mid) {
+        if (n == 0 || addr < addrs[1]) return "?"
+        lo = 1; hi = n
+        while (lo < hi) {
+            mid = int((lo + hi + 1) / 2)
+            if (addrs[mid] <= addr) lo = mid; else hi = mid - 1
+        }
+        return names[lo]
+    }
+
+    # nm: <addr> <type> <name>
+    FNR == NR {
+        if (NF < 3) next
+        if ($3 == "eos_profile_dump") anchor_sym = hex($1)
+        if ($2 ~ /^[tTwW]$/) { ntext++; taddr[ntext] = hex($1); tname[ntext] = $3 }
+        else if ($2 ~ /^[bBdDsS]$/) { ndata++; daddr[ndata] = hex($1); dname[ndata] = $3 }
+        next
+    }
+
+    { sub(/\r$/, "") }
+    $1 == "PROF" && $2 == "begin" {
+        delete fn; delete task; total = 0; offset = 0
+        for (i = 3; i <= NF; i++) if ($i ~ /^anchor=/) offset = hex(substr($i, 8)) - anchor_sym
+        next
+    }
+    $1 == "PROF" && $2 ~ /^0x/ {
+        fn[lookup(hex($2) - offset, tname, taddr, ntext)]++
+        task[lookup(hex($3) - offset, dname, daddr, ndata)]++
+        total++
+    }
+
+    END {
+        if (total == 0) { print "no PROF samples" > "/dev/stderr"; exit 1 }
+        printf "== functions (%d samples)\n", total
+        for (k in fn) printf "%6.2f%% %8d  %s\n", fn[k] * 100.0 / total, fn[k], k | "sort -rn"
+        close("sort -rn")
+        printf "\n== tasks\n"
+        for (k in task) printf "%6.2f%% %8d  %s\n", task[k] * 100.0 / total, task[k], k | "sort -rn"
+        close("sort -rn")
+    }' - "$LOG"
@@ -1,12 +1,21 @@
 #!/bin/bash
 set -e
 
+# GIC=3 for a kernel built with make GIC=3
+# DISK=<raw image> attaches it as a virtio-blk disk
+DRIVE=()
+if [ -n "$DISK" ]; then
+  DRIVE=(-drive "file=$DISK,if=none,format=raw,id=hd0" -device virtio-blk-device,drive=hd0)
+fi
+
 qemu-system-aarch64 \
-  -M virt,gic-version=2,virtualization=on \
+  -M virt,gic-version="${GIC:-2}",virtualization=on \
   -cpu cortex-a72 \
+  -smp "${SMP:-1}" \
   -m 128M \
   -serial stdio \
   -monitor tcp:127.0.0.1:5555,server,nowait \
   -kernel eos \
+  "${DRIVE[@]}" \
   -nographic \
   -no-reboot
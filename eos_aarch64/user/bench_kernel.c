@@ -0,0 +1,442 @@
+#include <core/eos.h>
+
+/*
+ * Kernel primitive microbenchmarks
+ *     All results are in CNTPCT cycles and printed as one line per run:
+ *         BENCH name=<benchmark> param=<p> n=<samples> avg=<a> min=<m> max=<M>
+ *     The run ends with "BENCH done" and powers QEMU off, so it can be
+ *     driven headless: make APP=bench_kernel && ./run.sh | grep '^BENCH'
+ *
+ *     ctxsw       one task switch (half of a yield round trip between equal priorities)
+ *     sem_pingpong release/acquire round trip between two tasks
+ *     mq          one send or receive of a param-byte message (no blocking; only
+ *                 with EOS_CFG_MQUEUE)
+ *     alarm       eos_set_alarm with param alarms already pending
+ *     irq         CNTV expiry to entry of the registered handler (only where the
+ *                 HAL exposes the virtual timer as IRQ_CNTV)
+ *     wake        eos_release_semaphore to the first instruction of the woken task
+ *     memcpy      _os_memcpy of param bytes (copy_loop: the plain byte loop it replaced)
+ *     memmove     _os_memmove of param bytes between overlapping buffers
+ *     memset      _os_memset of param bytes to zero
+ *     blk_write   one-sector sequential writes, per sector, with param requests
+ *                 in flight (only with a disk: DISK=<image> ./run.sh)
+ */
+
+#define BENCH_STACK_SIZE    8192
+#define BENCH_ITERS         1000
+#define BENCH_MQ_DEPTH      16
+#define BENCH_MQ_MAX_MSG    255
+#define BENCH_MAX_ALARMS    128
+#define BENCH_MEM_MAX       4096
+#define BENCH_BLK_SECTORS   256
+#define BENCH_BLK_RUNS      8
+
+#define CTRL_PRIORITY       10
+#define PEER_PRIORITY       9       // peers that must preempt the controller
+#define WAITER_PRIORITY     5
+
+typedef struct bench_stat {
+    int64u_t sum;
+    int32u_t n;
+    int32u_t min;
+    int32u_t max;
+} bench_stat_t;
+
+static eos_tcb_t ctrl_tcb;
+static eos_tcb_t yield_tcb;
+static eos_tcb_t pong_tcb;
+static eos_tcb_t waiter_tcb;
+static int64u_t ctrl_stack[BENCH_STACK_SIZE / 8];
+static int64u_t yield_stack[BENCH_STACK_SIZE / 8];
+static int64u_t pong_stack[BENCH_STACK_SIZE / 8];
+static int64u_t waiter_stack[BENCH_STACK_SIZE / 8];
+
+static eos_semaphore_t park_sem;    // never released: helpers block here when done
+static eos_semaphore_t ping_sem;
+static eos_semaphore_t pong_sem;
+static eos_semaphore_t wake_sem;
+
+#if EOS_CFG_MQUEUE
+static int8u_t mq_buffer[BENCH_MQ_DEPTH * BENCH_MQ_MAX_MSG];
+static int8u_t mq_msg[BENCH_MQ_MAX_MSG];
+static eos_mqueue_t mq;
+#endif
+
+static eos_alarm_t alarms[BENCH_MAX_ALARMS];
+static eos_alarm_t probe_alarm;
+
+static int64u_t mem_src[BENCH_MEM_MAX / 8];
+static int64u_t mem_dst[BENCH_MEM_MAX / 8 + 1];    // one spare word for memmove
+
+#if EOS_CFG_BLK
+static eos_blk_cq_t blk_cq;
+static eos_blk_request_t blk_reqs[EOS_CFG_BLK_QUEUE_DEPTH];
+static int64u_t blk_buf[BLK_SECTOR_SIZE / 8];
+#endif
+
+static bench_stat_t stat;
+static volatile int64u_t wake_stamp;
+#ifdef IRQ_CNTV
+static volatile int32u_t irq_fired;
+#endif
+
+
+static void stat_reset(void)
+{
+    stat.sum = 0;
+    stat.n = 0;
+    stat.min = 0xFFFFFFFFu;
+    stat.max = 0;
+}
+
+
+static void stat_add(int64u_t cycles)
+{
+    int32u_t c = (int32u_t)cycles;
+
+    stat.sum += c;
+    stat.n++;
+    if (c < stat.min) stat.min = c;
+    if (c > stat.max) stat.max = c;
+}
+
+
+static void stat_print(const char *name, int32u_t param)
+{
+    eos_printf("BENCH name=%s param=%u n=%u avg=%u min=%u max=%u\n",
+               name, param, stat.n,
+               stat.n ? (int32u_t)(stat.sum / stat.n) : 0,
+               stat.n ? stat.min : 0, stat.max);
+}
+
+
+static void park(void)
+{
+    while (1) {
+        eos_acquire_semaphore(&park_sem, 0);
+    }
+}
+
+
+/* -------------------- Context switch -------------------- */
+static void yield_task(void *arg)
+{
+    for (int32u_t i = 0; i < BENCH_ITERS + 1; i++) {
+        eos_yield();
+    }
+    park();
+}
+
+
+static void bench_ctxsw(void)
+{
+    stat_reset();
+    eos_create_task(&yield_tcb, (addr_t)yield_stack, sizeof(yield_stack),
+                    yield_task, NULL, CTRL_PRIORITY);
+
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        int64u_t t0 = read_cntpct_el0();
+        eos_yield();
+        stat_add((read_cntpct_el0() - t0) / 2);
+    }
+    eos_yield();        // lets the peer finish and park
+    stat_print("ctxsw", 0);
+}
+
+
+/* -------------------- Semaphore ping-pong -------------------- */
+static void pong_task(void *arg)
+{
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        eos_acquire_semaphore(&ping_sem, 0);
+        eos_release_semaphore(&pong_sem);
+    }
+    park();
+}
+
+
+static void bench_sem_pingpong(void)
+{
+    stat_reset();
+    eos_init_semaphore(&ping_sem, 0, FIFO);
+    eos_init_semaphore(&pong_sem, 0, FIFO);
+    eos_create_task(&pong_tcb, (addr_t)pong_stack, sizeof(pong_stack),
+                    pong_task, NULL, PEER_PRIORITY);
+
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        int64u_t t0 = read_cntpct_el0();
+        eos_release_semaphore(&ping_sem);
+        eos_acquire_semaphore(&pong_sem, 0);
+        stat_add(read_cntpct_el0() - t0);
+    }
+    stat_print("sem_pingpong", 0);
+}
+
+
+/* -------------------- Message queue -------------------- */
+#if EOS_CFG_MQUEUE
+static void bench_mq(int8u_t msg_size)
+{
+    stat_reset();
+    eos_init_mqueue(&mq, mq_buffer, BENCH_MQ_DEPTH, msg_size, FIFO);
+
+    for (int32u_t r = 0; r < BENCH_ITERS / BENCH_MQ_DEPTH; r++) {
+        int64u_t t0 = read_cntpct_el0();
+        for (int32u_t i = 0; i < BENCH_MQ_DEPTH; i++) {
+            eos_send_message(&mq, mq_msg, -1);
+        }
+        for (int32u_t i = 0; i < BENCH_MQ_DEPTH; i++) {
+            eos_receive_message(&mq, mq_msg, -1);
+        }
+        stat_add((read_cntpct_el0() - t0) / (2 * BENCH_MQ_DEPTH));
+    }
+    stat_print("mq", msg_size);
+}
+#endif
+
+
+/* -------------------- Alarm insertion -------------------- */
+static void dummy_alarm_handler(void *arg)
+{
+}
+
+
+static void bench_alarm(int32u_t pending)
+{
+    eos_counter_t *timer = eos_get_system_timer();
+
+    stat_reset();
+
+    /* Far-future alarms that never fire during the run */
+    for (int32u_t i = 0; i < pending; i++) {
+        eos_set_alarm(timer, &alarms[i], 1000000 + i, dummy_alarm_handler, NULL);
+    }
+
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        int32u_t flag = hal_disable_interrupt();
+        int64u_t t0 = read_cntpct_el0();
+        eos_set_alarm(timer, &probe_alarm, 2000000, dummy_alarm_handler, NULL);
+        int64u_t t1 = read_cntpct_el0();
+        eos_set_alarm(timer, &probe_alarm, 0, NULL, NULL);
+        hal_restore_interrupt(flag);
+        stat_add(t1 - t0);
+    }
+
+    for (int32u_t i = 0; i < pending; i++) {
+        eos_set_alarm(timer, &alarms[i], 0, NULL, NULL);
+    }
+    stat_print("alarm", pending);
+}
+
+
+/* -------------------- IRQ latency -------------------- */
+#ifdef IRQ_CNTV
+static void cntv_handler(int8s_t irqnum, void *arg)
+{
+    int64u_t now = read_cntvct_el0();
+
+    write_cntv_ctl_el0(0);      // level-triggered: stop the timer before EOI
+    stat_add(now - read_cntv_cval_el0());
+    irq_fired = 1;
+}
+
+
+static void bench_irq(void)
+{
+    int64u_t delay = read_cntfrq_el0() / 1000;     // 1 ms
+
+    stat_reset();
+    eos_set_interrupt_handler(IRQ_CNTV, cntv_handler, NULL);
+    hal_enable_irq_line(IRQ_CNTV);
+
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        irq_fired = 0;
+        write_cntv_cval_el0(read_cntvct_el0() + delay);
+        write_cntv_ctl_el0(1);
+        while (!irq_fired) { }
+    }
+
+    hal_disable_irq_line(IRQ_CNTV);
+    eos_set_interrupt_handler(IRQ_CNTV, NULL, NULL);
+    stat_print("irq", 0);
+}
+#endif
+
+
+/* -------------------- Wake-to-run latency -------------------- */
+static void waiter_task(void *arg)
+{
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        eos_acquire_semaphore(&wake_sem, 0);
+        stat_add(read_cntpct_el0() - wake_stamp);
+    }
+    park();
+}
+
+
+static void bench_wake(void)
+{
+    stat_reset();
+    eos_init_semaphore(&wake_sem, 0, PRIORITY);
+    eos_create_task(&waiter_tcb, (addr_t)waiter_stack, sizeof(waiter_stack),
+                    waiter_task, NULL, WAITER_PRIORITY);
+
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        wake_stamp = read_cntpct_el0();
+        eos_release_semaphore(&wake_sem);
+    }
+    stat_print("wake", 0);
+}
+
+
+/* -------------------- Memory copy and fill -------------------- */
+static void copy_loop(void *dst, const void *src, size_t n)
+{
+    int8u_t *d = dst;
+    const int8u_t *s = src;
+
+    for (size_t i = 0; i < n; i++) {
+        d[i] = s[i];
+    }
+}
+
+
+static void bench_mem(int32u_t size)
+{
+    int64u_t t0;
+
+    stat_reset();
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        t0 = read_cntpct_el0();
+        copy_loop(mem_dst, mem_src, size);
+        stat_add(read_cntpct_el0() - t0);
+    }
+    stat_print("copy_loop", size);
+
+    stat_reset();
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        t0 = read_cntpct_el0();
+        _os_memcpy(mem_dst, mem_src, size);
+        stat_add(read_cntpct_el0() - t0);
+    }
+    stat_print("memcpy", size);
+
+    /* Overlapping by one word: takes the backward path */
+    stat_reset();
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        t0 = read_cntpct_el0();
+        _os_memmove(&mem_dst[1], mem_dst, size);
+        stat_add(read_cntpct_el0() - t0);
+    }
+    stat_print("memmove", size);
+
+    stat_reset();
+    for (int32u_t i = 0; i < BENCH_ITERS; i++) {
+        t0 = read_cntpct_el0();
+        _os_memset(mem_dst, 0, size);
+        stat_add(read_cntpct_el0() - t0);
+    }
+    stat_print("memset", size);
+}
+
+
+#if EOS_CFG_BLK
+/* -------------------- Block writes -------------------- */
+static void bench_blk(int32u_t depth)
+{
+    eos_blk_request_t *idle[EOS_CFG_BLK_QUEUE_DEPTH];
+    eos_blk_request_t *batch[EOS_CFG_BLK_QUEUE_DEPTH];
+
+    stat_reset();
+    eos_blk_init_cq(&blk_cq);
+
+    for (int32u_t run = 0; run < BENCH_BLK_RUNS; run++) {
+        int32u_t nidle = depth, next = 0, done = 0;
+        int64u_t t0 = read_cntpct_el0();
+
+        for (int32u_t i = 0; i < depth; i++) {
+            idle[i] = &blk_reqs[i];
+        }
+        while (done < BENCH_BLK_SECTORS) {
+            eos_blk_request_t *req;
+            int32u_t n = 0, accepted;
+
+            /* Refills the pipeline: one notification per batch */
+            while (nidle > 0 && next < BENCH_BLK_SECTORS) {
+                req = idle[--nidle];
+                req->op = BLK_WRITE;
+                req->sector = next++;
+                req->count = 1;
+                req->buf = blk_buf;
+                req->cq = &blk_cq;
+                batch[n++] = req;
+            }
+            accepted = eos_blk_submit(batch, n);
+            while (accepted < n) {
+                idle[nidle++] = batch[--n];
+                next--;
+            }
+
+            req = eos_blk_wait(&blk_cq, 0);
+            idle[nidle++] = req;
+            done++;
+            while ((req = eos_blk_wait(&blk_cq, -1)) != NULL) {
+                idle[nidle++] = req;
+                done++;
+            }
+        }
+        stat_add((read_cntpct_el0() - t0) / BENCH_BLK_SECTORS);
+    }
+    stat_print("blk_write", depth);
+}
+#endif
+
+
+static void ctrl_task(void *arg)
+{
+#if EOS_CFG_MQUEUE
+    static const int8u_t msg_sizes[] = { 4, 16, 64, BENCH_MQ_MAX_MSG };
+#endif
+    static const int32u_t pending_alarms[] = { 0, 8, 32, BENCH_MAX_ALARMS };
+    static const int32u_t mem_sizes[] = { 8, 64, 255, BENCH_MEM_MAX };
+
+    eos_printf("BENCH start freq=%u\n", (int32u_t)read_cntfrq_el0());
+
+    bench_ctxsw();
+    bench_sem_pingpong();
+#if EOS_CFG_MQUEUE
+    for (int32u_t i = 0; i < sizeof(msg_sizes) / sizeof(msg_sizes[0]); i++) {
+        bench_mq(msg_sizes[i]);
+    }
+#endif
+    for (int32u_t i = 0; i < sizeof(pending_alarms) / sizeof(pending_alarms[0]); i++) {
+        bench_alarm(pending_alarms[i]);
+    }
+#ifdef IRQ_CNTV
+    bench_irq();
+#endif
+    bench_wake();
+    for (int32u_t i = 0; i < sizeof(mem_sizes) / sizeof(mem_sizes[0]); i++) {
+        bench_mem(mem_sizes[i]);
+    }
+#if EOS_CFG_BLK
+    if (eos_blk_capacity() >= BENCH_BLK_SECTORS) {
+        static const int32u_t blk_depths[] = { 1, 8, EOS_CFG_BLK_QUEUE_DEPTH };
+
+        for (int32u_t i = 0; i < sizeof(blk_depths) / sizeof(blk_depths[0]); i++) {
+            bench_blk(blk_depths[i]);
+        }
+    }
+#endif
+
+    eos_printf("BENCH done\n");
+    hal_system_off();
+}
+
+
+void eos_user_main()
+{
+    eos_init_semaphore(&park_sem, 0, FIFO);
+    eos_create_task(&ctrl_tcb, (addr_t)ctrl_stack, sizeof(ctrl_stack),
+                    ctrl_task, NULL, CTRL_PRIORITY);
+}
@@ -0,0 +1,160 @@
+#include <core/eos.h>
+
+/*
+ * Spinlock contention benchmark
+ *     Every participating core repeatedly takes the lock, increments a
+ *     shared counter and releases it for a fixed window of CNTPCT time.
+ *     Each run prints one line:
+ *         LOCKBENCH impl=<tas|ticket|mcs> cpus=<n> acq=<total> cycles_per_acq=<c> min=<m> max=<M> ok=<0|1>
+ *     min/max are the per-core acquisition counts (fairness), ok checks
+ *     the shared counter against the sum of acquisitions (mutual exclusion).
+ *
+ *     Secondary cores are started through PSCI: run with "SMP=4 ./run.sh".
+ *     Build with "make APP=bench_spinlock".
+ */
+
+#define BENCH_WINDOW_DIV    10      // window = 1/10 s
+#define BENCH_STACK_SIZE    4096
+#define BENCH_BOOT_TIMEOUT  1000000
+
+enum { IMPL_TAS, IMPL_TICKET, IMPL_MCS, IMPL_COUNT };
+static const char *impl_names[IMPL_COUNT] = { "tas", "ticket", "mcs" };
+
+static _os_taslock_t tas_lock = SPINLOCK_UNLOCKED;
+static _os_ticketlock_t ticket_lock = SPINLOCK_UNLOCKED;
+static _os_mcslock_t mcs_lock = NULL;
+static _os_mcs_node_t mcs_nodes[MAX_CPUS];
+
+static volatile int32u_t shared_counter;
+static volatile int32u_t bench_impl;
+static volatile int32u_t bench_cpus;        // cores taking part in the current run
+static volatile int32u_t bench_round;       // incremented to start a run
+static volatile int32u_t bench_stop;
+static volatile int32s_t bench_done;        // secondaries finished with the current run
+static volatile int32s_t cpus_online;       // secondaries started
+static volatile int32u_t acquisitions[MAX_CPUS];
+
+static int8u_t cpu_stacks[MAX_CPUS][BENCH_STACK_SIZE] __attribute__((aligned(16)));
+static _os_cpu_boot_t cpu_boot[MAX_CPUS];
+
+
+static void bench_signal(void)
+{
+    __asm__ volatile("dsb sy; sev" ::: "memory");
+}
+
+
+/* Core 0 also ends the window once deadline has passed */
+static void contend(int32u_t cpu, int64u_t deadline)
+{
+    int32u_t n = 0;
+
+    while (!bench_stop) {
+        switch (bench_impl) {
+        case IMPL_TAS:
+            _os_tas_lock(&tas_lock);
+            shared_counter++;
+            _os_tas_unlock(&tas_lock);
+            break;
+        case IMPL_TICKET:
+            _os_ticket_lock(&ticket_lock);
+            shared_counter++;
+            _os_ticket_unlock(&ticket_lock);
+            break;
+        default:
+            _os_mcs_lock(&mcs_lock, &mcs_nodes[cpu]);
+            shared_counter++;
+            _os_mcs_unlock(&mcs_lock, &mcs_nodes[cpu]);
+            break;
+        }
+        n++;
+
+        if (cpu == 0 && (n & 0x3F) == 0 && read_cntpct_el0() >= deadline) {
+            bench_stop = 1;
+            bench_signal();
+        }
+    }
+    acquisitions[cpu] = n;
+}
+
+
+static void secondary_main(void *arg)
+{
+    int32u_t cpu = (int32u_t)(int64u_t)arg;
+    int32u_t seen = 0;
+
+    _os_atomic_fetch_add(&cpus_online, 1);
+
+    while (1) {
+        while (bench_round == seen) {
+            __asm__ volatile("wfe" ::: "memory");
+        }
+        seen = bench_round;
+
+        if (cpu < bench_cpus) {
+            contend(cpu, 0);
+        }
+        _os_atomic_fetch_add(&bench_done, 1);
+    }
+}
+
+
+static void run(int32u_t impl, int32u_t cpus, int64u_t window)
+{
+    shared_counter = 0;
+    bench_impl = impl;
+    bench_cpus = cpus;
+    bench_stop = 0;
+    bench_done = 0;
+    for (int32u_t i = 0; i < MAX_CPUS; i++) {
+        acquisitions[i] = 0;
+    }
+
+    int64u_t start = read_cntpct_el0();
+    bench_round++;
+    bench_signal();
+
+    contend(0, start + window);
+    int64u_t elapsed = read_cntpct_el0() - start;
+
+    while (bench_done != cpus_online) { }
+
+    int32u_t total = 0, min = 0xFFFFFFFFu, max = 0;
+    for (int32u_t i = 0; i < cpus; i++) {
+        total += acquisitions[i];
+        if (acquisitions[i] < min) min = acquisitions[i];
+        if (acquisitions[i] > max) max = acquisitions[i];
+    }
+
+    eos_printf("LOCKBENCH impl=%s cpus=%u acq=%u cycles_per_acq=%u min=%u max=%u ok=%u\n",
+               impl_names[impl], cpus, total,
+               total ? (int32u_t)(elapsed / total) : 0, min, max,
+               (int32u_t)(shared_counter == total));
+}
+
+
+void eos_user_main()
+{
+    int64u_t window = read_cntfrq_el0() / BENCH_WINDOW_DIV;
+    int32s_t started = 0;
+
+    /* Brings up the secondary cores */
+    for (int32u_t cpu = 1; cpu < MAX_CPUS; cpu++) {
+        cpu_boot[cpu].stack_top = (int64u_t)&cpu_stacks[cpu][BENCH_STACK_SIZE];
+        cpu_boot[cpu].entry = secondary_main;
+        cpu_boot[cpu].arg = (void *)(int64u_t)cpu;
+        if (hal_start_cpu(cpu, &cpu_boot[cpu]) == 0) {
+            started++;
+        }
+    }
+    for (int32u_t spin = 0; cpus_online != started && spin < BENCH_BOOT_TIMEOUT; spin++) { }
+
+    int32u_t ncpus = 1 + (int32u_t)cpus_online;
+    eos_printf("LOCKBENCH cpus_online=%u window_cycles=%u\n", ncpus, (int32u_t)window);
+
+    for (int32u_t impl = 0; impl < IMPL_COUNT; impl++) {
+        for (int32u_t cpus = 1; cpus <= ncpus; cpus++) {
+            run(impl, cpus, window);
+        }
+    }
+}